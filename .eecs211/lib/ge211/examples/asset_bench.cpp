@@ -0,0 +1,114 @@
+// Benchmark for loading assets at startup.
+//
+// Loads the same font many times, the way a game whose views each
+// construct their own Font%s does, and compares:
+//
+//  - finding the file by walking the search prefixes every time, as
+//    File_resource used to, against the resolved-path index;
+//  - loading each Font from scratch, which is what every construction
+//    used to cost, against constructing it while the asset cache already
+//    holds a copy.
+//
+// Pass a font filename to use something other than the built-in sans.ttf.
+// This does not open a window.
+
+#include <ge211.h>
+
+#include <SDL.h>
+
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace ge211;
+using namespace std;
+
+// CONSTANTS
+
+int const load_count{1000};
+int const font_sizes[] = {24, 48};
+
+// Opens the file the way File_resource did before the index: try each
+// search prefix until one works.
+static bool walk_search_prefixes(string const& filename)
+{
+    for (char const* prefix : detail::get_search_prefixes()) {
+        SDL_RWops* rwops = SDL_RWFromFile((prefix + filename).c_str(), "rb");
+        if (rwops) {
+            SDL_RWclose(rwops);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void report(char const* what, Duration total, int count)
+{
+    cout << setw(28) << left << what << right
+         << setw(12) << fixed << setprecision(2)
+         << total.seconds() * 1e6 / count << " µs/load\n";
+}
+
+int main(int argc, char* argv[])
+{
+    string filename = argc > 1 ? argv[1] : "sans.ttf";
+
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+    SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+    detail::Session session;
+
+    int found = 0;
+
+    // The first load pays for the prefix walk, reading the file, and
+    // parsing the font.
+    Timer cold_timer;
+    auto first = make_unique<Font>(filename, font_sizes[0]);
+    report("first font (cold)", cold_timer.elapsed_time(), 1);
+
+    Timer walk_timer;
+    for (int i = 0; i < load_count; ++i)
+        found += walk_search_prefixes(filename);
+    report("open: walk prefixes", walk_timer.elapsed_time(), load_count);
+
+    Timer index_timer;
+    for (int i = 0; i < load_count; ++i) {
+        detail::File_resource file(filename);
+        found += file.get_raw() != nullptr;
+    }
+    report("open: resolved-path index", index_timer.elapsed_time(),
+           load_count);
+
+    // Drops the cached font so that every construction below misses.
+    first.reset();
+
+    Timer uncached_timer;
+    for (int i = 0; i < load_count; ++i) {
+        for (int size : font_sizes) {
+            Font font(filename, size);
+            (void) font;
+        }
+    }
+    report("font: no live copy", uncached_timer.elapsed_time(),
+           load_count * int(sizeof font_sizes / sizeof(int)));
+
+    // Holding one font of each size keeps them in the cache, as a View
+    // does while the game runs.
+    vector<Font> held;
+    for (int size : font_sizes)
+        held.emplace_back(filename, size);
+
+    Timer cached_timer;
+    for (int i = 0; i < load_count; ++i) {
+        for (int size : font_sizes) {
+            Font font(filename, size);
+            (void) font;
+        }
+    }
+    report("font: cached", cached_timer.elapsed_time(),
+           load_count * int(sizeof font_sizes / sizeof(int)));
+
+    return found == 2 * load_count ? 0 : 1;
+}
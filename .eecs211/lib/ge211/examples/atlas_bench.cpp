@@ -0,0 +1,131 @@
+// Draw-call throughput benchmark for Sprite_atlas.
+//
+// Renders a large number of small balls in four alternating colors, so
+// that consecutive copies switch textures every time unless the ball
+// sprites share an atlas. Press `a` to toggle between separate textures
+// and the atlas; the frame rate is shown in the corner and printed every
+// few seconds.
+
+#include <ge211.h>
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ge211;
+using namespace std;
+
+// CONSTANTS
+
+Dimensions const scene_dimensions{1024, 768};
+int const ball_count{50000};
+int const ball_radius{3};
+int const color_count{4};
+double const report_seconds{3};
+
+// VIEW
+
+struct View
+{
+    View();
+
+    Font sans{"sans.ttf", 24};
+    Text_sprite status;
+
+    // Each set has one sprite per color; the second is packed.
+    vector<Circle_sprite> loose;
+    vector<Circle_sprite> packed;
+};
+
+View::View()
+{
+    Sprite_atlas atlas;
+
+    for (int i = 0; i < color_count; ++i) {
+        Color color = Color::from_hsla(360.0 * i / color_count, .75, .5);
+        loose.emplace_back(ball_radius, color);
+        packed.emplace_back(ball_radius, color);
+    }
+
+    for (Circle_sprite& sprite : packed)
+        atlas.pack(sprite);
+}
+
+// MAIN STRUCT AND FUNCTION
+
+struct Atlas_bench : Abstract_game
+{
+    vector<Position> balls;
+    View view;
+    bool use_atlas = true;
+    Timer since_report;
+
+    Atlas_bench();
+
+    Dimensions initial_window_dimensions() const override;
+    void on_start() override;
+    void on_key(Key key) override;
+    void on_frame(double dt) override;
+    void draw(Sprite_set& sprites) override;
+};
+
+int main()
+{
+    Atlas_bench{}.run();
+}
+
+// FUNCTION DEFINITIONS
+
+Atlas_bench::Atlas_bench()
+{
+    Random& rng = get_random();
+
+    for (int i = 0; i < ball_count; ++i) {
+        balls.push_back({rng.up_to(scene_dimensions.width),
+                         rng.up_to(scene_dimensions.height)});
+    }
+}
+
+Dimensions Atlas_bench::initial_window_dimensions() const
+{
+    return scene_dimensions;
+}
+
+void Atlas_bench::on_start()
+{
+    for (Circle_sprite const& sprite : view.loose) prepare(sprite);
+    for (Circle_sprite const& sprite : view.packed) prepare(sprite);
+}
+
+void Atlas_bench::on_key(Key key)
+{
+    if (key == Key::code('a')) {
+        use_atlas = !use_atlas;
+    } else if (key == Key::code('q')) {
+        quit();
+    }
+}
+
+void Atlas_bench::on_frame(double)
+{
+    if (since_report.elapsed_time().seconds() >= report_seconds) {
+        since_report.reset();
+        cout << (use_atlas ? "atlas:   " : "loose:   ")
+             << setprecision(4) << get_frame_rate() << " fps, "
+             << get_frame_rate() * ball_count << " copies/s\n";
+    }
+}
+
+void Atlas_bench::draw(Sprite_set& sprites)
+{
+    view.status.reconfigure(Text_sprite::Builder(view.sans)
+                                    << (use_atlas ? "atlas " : "loose ")
+                                    << setprecision(3)
+                                    << get_frame_rate());
+    sprites.add_sprite(view.status, {10, 10}, 1);
+
+    vector<Circle_sprite> const& set = use_atlas ? view.packed : view.loose;
+
+    for (size_t i = 0; i < balls.size(); ++i)
+        sprites.add_sprite(set[i % color_count], balls[i]);
+}
@@ -0,0 +1,178 @@
+// Stress scene for Circle_batch_sprite.
+//
+// Bounces a couple hundred thousand small balls around the window. By
+// default they are drawn as one Circle_batch_sprite; press `b` to switch
+// to one (atlas-packed) Circle_sprite per ball and back. The frame rate
+// is shown in the corner and printed every few seconds.
+
+#include <ge211.h>
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ge211;
+using namespace std;
+
+// CONSTANTS
+
+Dimensions const scene_dimensions{1024, 768};
+int const ball_count{200000};
+int const ball_radius{2};
+int const max_speed{120};
+int const color_count{4};
+double const report_seconds{3};
+
+// MODEL
+
+struct Ball
+{
+    Basic_position<double> position;
+    Basic_dimensions<double> velocity;
+    int color;
+};
+
+struct Model
+{
+    explicit Model(Random&);
+
+    void update(double dt);
+
+    vector<Ball> balls;
+};
+
+// VIEW
+
+struct View
+{
+    View();
+
+    void draw(Sprite_set&, Model const&, bool use_batch, double fps);
+
+    Font sans{"sans.ttf", 24};
+    Text_sprite status;
+
+    vector<Color> colors;
+    vector<Circle_sprite> sprites;
+    Circle_batch_sprite batch{scene_dimensions};
+};
+
+// MAIN STRUCT AND FUNCTION
+
+struct Ball_storm : Abstract_game
+{
+    Model model{get_random()};
+    View view;
+    bool use_batch = true;
+    Timer since_report;
+
+    Dimensions initial_window_dimensions() const override;
+    void on_key(Key key) override;
+    void on_frame(double dt) override;
+    void draw(Sprite_set& sprites) override;
+};
+
+int main()
+{
+    Ball_storm{}.run();
+}
+
+// FUNCTION DEFINITIONS FOR MODEL
+
+Model::Model(Random& rng)
+{
+    for (int i = 0; i < ball_count; ++i) {
+        Basic_position<double> position{
+                double(rng.up_to(scene_dimensions.width - 2 * ball_radius)),
+                double(rng.up_to(scene_dimensions.height - 2 * ball_radius))};
+        Basic_dimensions<double> velocity{
+                double(rng.between(-max_speed, max_speed)),
+                double(rng.between(-max_speed, max_speed))};
+        balls.push_back({position, velocity, i % color_count});
+    }
+}
+
+void Model::update(double dt)
+{
+    double right = scene_dimensions.width - 2 * ball_radius;
+    double bottom = scene_dimensions.height - 2 * ball_radius;
+
+    for (Ball& ball : balls) {
+        ball.position = ball.position + ball.velocity * dt;
+
+        if (ball.position.x < 0 || ball.position.x > right)
+            ball.velocity.width *= -1;
+        if (ball.position.y < 0 || ball.position.y > bottom)
+            ball.velocity.height *= -1;
+    }
+}
+
+// FUNCTION DEFINITIONS FOR VIEW
+
+View::View()
+{
+    Sprite_atlas atlas;
+
+    for (int i = 0; i < color_count; ++i) {
+        colors.push_back(Color::from_hsla(360.0 * i / color_count, .75, .5));
+        sprites.emplace_back(ball_radius, colors.back());
+    }
+
+    for (Circle_sprite& sprite : sprites)
+        atlas.pack(sprite);
+
+    batch.reserve(ball_count);
+}
+
+void View::draw(Sprite_set& set, Model const& model, bool use_batch,
+                double fps)
+{
+    status.reconfigure(Text_sprite::Builder(sans)
+                               << (use_batch ? "batch " : "sprites ")
+                               << setprecision(3) << fps);
+    set.add_sprite(status, {10, 10}, 1);
+
+    if (use_batch) {
+        batch.clear();
+        for (Ball const& ball : model.balls)
+            batch.add_circle(ball.position.into<int>(), ball_radius,
+                             colors[ball.color]);
+        set.add_sprite(batch, {0, 0});
+    } else {
+        for (Ball const& ball : model.balls)
+            set.add_sprite(sprites[ball.color], ball.position.into<int>());
+    }
+}
+
+// FUNCTION DEFINITIONS FOR CONTROLLER
+
+Dimensions Ball_storm::initial_window_dimensions() const
+{
+    return scene_dimensions;
+}
+
+void Ball_storm::on_key(Key key)
+{
+    if (key == Key::code('b')) {
+        use_batch = !use_batch;
+    } else if (key == Key::code('q')) {
+        quit();
+    }
+}
+
+void Ball_storm::on_frame(double dt)
+{
+    model.update(dt);
+
+    if (since_report.elapsed_time().seconds() >= report_seconds) {
+        since_report.reset();
+        cout << (use_batch ? "batch:   " : "sprites: ")
+             << setprecision(4) << get_frame_rate() << " fps, "
+             << 1000 / get_frame_rate() << " ms/frame\n";
+    }
+}
+
+void Ball_storm::draw(Sprite_set& sprites)
+{
+    view.draw(sprites, model, use_batch, get_frame_rate());
+}
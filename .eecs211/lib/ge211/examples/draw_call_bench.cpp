@@ -0,0 +1,93 @@
+// Benchmark for the overhead of one draw call.
+//
+// Measures the cost of rendering one small sprite, for a sprite with its
+// own texture, for regions of an atlas, and for tinted and scaled
+// sprites. Each case renders the same frame with and without
+// `draw_count` sprites and reports the difference per sprite, so clearing
+// and reading back the frame don't count.
+//
+// This renders offscreen and does not open a window.
+
+#include <ge211.h>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+
+using namespace ge211;
+using namespace std;
+
+// CONSTANTS
+
+int const draw_count{20000};
+int const timed_frames{10};
+Dimensions const screen{200, 200};
+
+// The average time to render a frame, in milliseconds.
+template <class DRAW>
+static double time_frames(Offscreen_renderer& offscreen, DRAW draw)
+{
+    // The first frame uploads the textures.
+    offscreen.render(draw);
+
+    Timer timer;
+    for (int i = 0; i < timed_frames; ++i)
+        offscreen.render(draw);
+    return timer.elapsed_time().seconds() * 1000 / timed_frames;
+}
+
+// Renders `draw_count` sprites with `add` and prints the cost of each.
+template <class ADD>
+static void measure(string const& name, ADD add)
+{
+    Offscreen_renderer offscreen(screen);
+
+    double empty_ms = time_frames(offscreen, [](Sprite_set&) { });
+    double full_ms = time_frames(offscreen, [&](Sprite_set& sprites) {
+        sprites.reserve(draw_count);
+        for (int i = 0; i < draw_count; ++i)
+            add(sprites, i);
+    });
+
+    double ns = (full_ms - empty_ms) * 1e6 / draw_count;
+    cout << setw(10) << name << setw(10) << fixed << setprecision(1)
+         << ns << "\n";
+}
+
+// Spreads the sprites over the screen.
+static Position place(int i)
+{
+    return {i * 7 % (screen.width - 4), i * 13 % (screen.height - 4)};
+}
+
+int main()
+{
+    Rectangle_sprite green{{4, 4}, Color{0, 200, 0}};
+    Rectangle_sprite red{{4, 4}, Color{200, 0, 0}};
+    Rectangle_sprite blue{{4, 4}, Color{0, 0, 200}};
+    Sprite_atlas atlas;
+    atlas.pack(red);
+    atlas.pack(blue);
+
+    Rectangle_sprite white{{4, 4}};
+    Transform const tint = Transform::tint(Color{0, 0, 200});
+    Transform const scale = Transform::scale(2);
+
+    cout << setw(10) << "sprite" << setw(10) << "ns" << "\n";
+
+    measure("texture", [&](Sprite_set& sprites, int i) {
+        sprites.add_sprite(green, place(i));
+    });
+
+    measure("atlas", [&](Sprite_set& sprites, int i) {
+        sprites.add_sprite(i % 2 ? blue : red, place(i));
+    });
+
+    measure("tinted", [&](Sprite_set& sprites, int i) {
+        sprites.add_sprite(white, place(i), 0, tint);
+    });
+
+    measure("scaled", [&](Sprite_set& sprites, int i) {
+        sprites.add_sprite(white, place(i), 0, scale);
+    });
+}
@@ -0,0 +1,108 @@
+// Benchmark for the logger.
+//
+// Measures how long the emitting thread spends on each log statement,
+// for the asynchronous logger and, for comparison, for writing the same
+// line straight to std::cerr with std::endl the way Log_message used to.
+// It also measures a debug() statement, which costs nothing when debug
+// messages are removed at compile time (GE211_MIN_LOG_LEVEL >= 1).
+//
+// The logged lines go to stderr, so run it as `log_bench 2>/dev/null` (or
+// redirect stderr to a file) to keep the terminal out of the numbers.
+// This does not open a window.
+
+#include <ge211.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace ge211;
+using namespace std;
+
+// CONSTANTS
+
+// One message per frame of a long-running game, emitted in bursts the
+// size of a frame's worth of work.
+int const message_count{20000};
+int const burst_size{10};
+auto const burst_gap = chrono::microseconds(500);
+
+struct Stats
+{
+    double messages_per_second;
+    double mean_ns;
+    double p99_ns;
+    double max_ns;
+};
+
+// Calls `emit(i)` message_count times in bursts and times each call.
+template <class FN>
+static Stats measure(FN emit)
+{
+    vector<double> times;
+    times.reserve(message_count);
+
+    Timer total;
+    Duration spent;
+
+    for (int i = 0; i < message_count; ++i) {
+        Timer one;
+        emit(i);
+        Duration t = one.elapsed_time();
+        times.push_back(t.seconds() * 1e9);
+        spent += t;
+
+        if (i % burst_size == burst_size - 1)
+            this_thread::sleep_for(burst_gap);
+    }
+
+    sort(times.begin(), times.end());
+    double sum = 0;
+    for (double t : times) sum += t;
+
+    return {message_count / spent.seconds(),
+            sum / times.size(),
+            times[times.size() * 99 / 100],
+            times.back()};
+}
+
+static void print_row(char const* name, Stats stats)
+{
+    cout << setw(10) << name
+         << fixed << setprecision(0)
+         << setw(14) << stats.messages_per_second
+         << setw(10) << stats.mean_ns
+         << setw(10) << stats.p99_ns
+         << setw(12) << stats.max_ns << "\n";
+    cout.unsetf(ios::fixed);
+}
+
+int main()
+{
+    detail::Logger& logger = detail::Logger::instance();
+    logger.level(detail::Log_level::debug);
+
+    cout << setw(10) << "logger"
+         << setw(14) << "msgs/s"
+         << setw(10) << "mean ns"
+         << setw(10) << "p99 ns"
+         << setw(12) << "max ns" << "\n";
+
+    print_row("sync", measure([](int i) {
+        cerr << "ge211[info]: frame " << i << " took "
+             << 16.7 << " ms" << endl;
+    }));
+
+    print_row("async", measure([](int i) {
+        detail::info() << "frame " << i << " took " << 16.7 << " ms";
+    }));
+
+    print_row("debug", measure([](int i) {
+        detail::debug() << "frame " << i << " took " << 16.7 << " ms";
+    }));
+
+    logger.flush();
+    cout << "messages dropped: " << logger.dropped() << "\n";
+}
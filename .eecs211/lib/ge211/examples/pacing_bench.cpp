@@ -0,0 +1,123 @@
+// Benchmark for frame pacing.
+//
+// Simulates frames that take a random amount of work and paces them at
+// several target rates, first the way the engine used to (sleeping for
+// whatever is left of the frame, measured from when the frame started)
+// and then with detail::Frame_pacer. Prints the mean and standard
+// deviation of the interval between frames, and the worst deviation
+// from the target. This does not open a window.
+
+#include <ge211.h>
+#include <ge211_engine.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace ge211;
+using namespace std;
+
+// CONSTANTS
+
+double const rates[] = {60, 120, 144};
+int const frames_per_run{240};
+// Each simulated frame does between 0 and this much work.
+double const max_work_fraction{0.5};
+
+struct Stats
+{
+    double mean_ms;
+    double stddev_ms;
+    double worst_ms;
+};
+
+static Stats compute_stats(vector<double> const& intervals, double target)
+{
+    double sum = 0;
+    for (double i : intervals) sum += i;
+    double mean = sum / intervals.size();
+
+    double squares = 0, worst = 0;
+    for (double i : intervals) {
+        squares += (i - mean) * (i - mean);
+        worst = max(worst, abs(i - target));
+    }
+
+    return {1000 * mean,
+            1000 * sqrt(squares / intervals.size()),
+            1000 * worst};
+}
+
+// Busy-waits, standing in for a frame's work.
+static void work_for(double seconds)
+{
+    Timer timer;
+    while (timer.elapsed_time().seconds() < seconds) { }
+}
+
+// The old engine loop: sleep for the rest of the frame.
+static vector<double> run_sleep(double rate, mt19937& rng)
+{
+    uniform_real_distribution<double> work(0, max_work_fraction / rate);
+    vector<double> intervals;
+    Timer frame_start;
+
+    for (int i = 0; i < frames_per_run; ++i) {
+        work_for(work(rng));
+
+        double remaining = 1 / rate - frame_start.elapsed_time().seconds();
+        if (remaining > 0)
+            this_thread::sleep_for(chrono::duration<double>(remaining));
+
+        intervals.push_back(frame_start.reset().seconds());
+    }
+
+    return intervals;
+}
+
+static vector<double> run_pacer(double rate, mt19937& rng)
+{
+    uniform_real_distribution<double> work(0, max_work_fraction / rate);
+    vector<double> intervals;
+    detail::Frame_pacer pacer;
+    Timer frame_start;
+
+    for (int i = 0; i < frames_per_run; ++i) {
+        work_for(work(rng));
+        pacer.wait(Duration(1 / rate));
+        intervals.push_back(frame_start.reset().seconds());
+    }
+
+    return intervals;
+}
+
+static void print_row(char const* method, double rate, Stats stats)
+{
+    cout << setw(8) << method
+         << setw(6) << rate
+         << fixed << setprecision(3)
+         << setw(12) << stats.mean_ms
+         << setw(12) << stats.stddev_ms
+         << setw(12) << stats.worst_ms << "\n";
+    cout.unsetf(ios::fixed);
+}
+
+int main()
+{
+    mt19937 rng;
+
+    cout << setw(8) << "method"
+         << setw(6) << "Hz"
+         << setw(12) << "mean ms"
+         << setw(12) << "stddev ms"
+         << setw(12) << "worst ms" << "\n";
+
+    for (double rate : rates) {
+        print_row("sleep", rate, compute_stats(run_sleep(rate, rng), 1 / rate));
+        print_row("pacer", rate, compute_stats(run_pacer(rate, rng), 1 / rate));
+    }
+}
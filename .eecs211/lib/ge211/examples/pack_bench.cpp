@@ -0,0 +1,130 @@
+// Benchmark for loading resources from a resource pack.
+//
+// Reads every file in a pack two ways: as loose files, found by trying
+// each search prefix with SDL_RWFromFile the way File_resource does
+// without a pack, and from the memory-mapped pack through
+// SDL_RWFromConstMem. The first pass of each is the cold start, which for
+// the pack includes mapping it; the rest are averaged as warm starts.
+// For a truly cold first pass, drop the OS file cache before running
+// (on Linux, `sync; echo 3 | sudo tee /proc/sys/vm/drop_caches`).
+//
+// Usage: pack_bench <pack>
+//
+// The loose files must be where the engine would find them.
+// This does not open a window.
+
+#include <ge211.h>
+#include <ge211_pack.h>
+
+#include <SDL.h>
+
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ge211;
+using namespace std;
+
+using detail::Resource_pack;
+
+// CONSTANTS
+
+int const warm_passes{50};
+
+// Reads everything from `rwops` and closes it, returning the byte count.
+static size_t drain(SDL_RWops* rwops)
+{
+    static char buffer[64 * 1024];
+    size_t total = 0, count;
+
+    while ((count = SDL_RWread(rwops, buffer, 1, sizeof buffer)) > 0)
+        total += count;
+
+    SDL_RWclose(rwops);
+    return total;
+}
+
+static size_t load_loose(vector<string> const& names)
+{
+    size_t total = 0;
+
+    for (string const& name : names) {
+        for (char const* prefix : detail::get_search_prefixes()) {
+            SDL_RWops* rwops = SDL_RWFromFile((prefix + name).c_str(), "rb");
+            if (rwops) {
+                total += drain(rwops);
+                break;
+            }
+        }
+    }
+
+    return total;
+}
+
+static size_t load_packed(Resource_pack const& pack,
+                          vector<string> const& names)
+{
+    size_t total = 0;
+
+    for (string const& name : names) {
+        unsigned char const* data;
+        size_t size;
+        if (pack.find(name, data, size))
+            total += drain(SDL_RWFromConstMem(data, int(size)));
+    }
+
+    return total;
+}
+
+static void report(char const* what, Duration cold, Duration warm)
+{
+    cout << setw(8) << left << what << right << fixed << setprecision(3)
+         << setw(12) << cold.seconds() * 1000
+         << setw(12) << warm.seconds() * 1000 / warm_passes << "\n";
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 2) {
+        cerr << "Usage: pack_bench <pack>\n";
+        return 2;
+    }
+
+    // The pack's own names say which loose files to compare against.
+    // This reads only the pack's directory.
+    vector<string> names = Resource_pack(argv[1]).names();
+    if (names.empty()) {
+        cerr << "pack_bench: could not load " << argv[1] << "\n";
+        return 1;
+    }
+
+    cout << names.size() << " files\n"
+         << setw(8) << left << "" << right
+         << setw(12) << "cold ms" << setw(12) << "warm ms" << "\n";
+
+    // Loose files first, so the pack doesn't warm the OS cache for them.
+    Timer loose_cold_timer;
+    size_t loose_bytes = load_loose(names);
+    Duration loose_cold = loose_cold_timer.elapsed_time();
+
+    Timer loose_warm_timer;
+    for (int i = 0; i < warm_passes; ++i)
+        loose_bytes += load_loose(names);
+    Duration loose_warm = loose_warm_timer.elapsed_time();
+
+    Timer pack_cold_timer;
+    Resource_pack pack(argv[1]);
+    size_t pack_bytes = load_packed(pack, names);
+    Duration pack_cold = pack_cold_timer.elapsed_time();
+
+    Timer pack_warm_timer;
+    for (int i = 0; i < warm_passes; ++i)
+        pack_bytes += load_packed(pack, names);
+    Duration pack_warm = pack_warm_timer.elapsed_time();
+
+    report("loose", loose_cold, loose_warm);
+    report("pack", pack_cold, pack_warm);
+
+    return loose_bytes == pack_bytes ? 0 : 1;
+}
@@ -0,0 +1,61 @@
+// Benchmark for building sprites on several threads.
+//
+// Builds a frame of `sprite_count` small squares with
+// Sprite_set::add_parallel on 1 to 8 threads, and reports the average
+// time to build and merge them, not counting painting.
+//
+// This renders offscreen and does not open a window.
+
+#include <ge211.h>
+
+#include <iomanip>
+#include <iostream>
+
+using namespace ge211;
+using namespace std;
+
+// CONSTANTS
+
+size_t const sprite_count{200000};
+int const timed_frames{10};
+Dimensions const screen{400, 300};
+
+int main()
+{
+    Rectangle_sprite squares[3]{
+            Rectangle_sprite{{8, 8}, Color::medium_red()},
+            Rectangle_sprite{{8, 8}, Color::medium_green()},
+            Rectangle_sprite{{8, 8}, Color::medium_blue()},
+    };
+
+    auto build = [&](Sprite_list& list, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            // Every seventh entity has nothing to draw.
+            if (i % 7 == 0) continue;
+
+            Position position{int(i * 37 % (screen.width - 8)),
+                              int(i * 53 % (screen.height - 8))};
+            list.add_sprite(squares[i % 3], position, int(i % 2));
+        }
+    };
+
+    Offscreen_renderer offscreen(screen);
+
+    cout << setw(10) << "threads" << setw(12) << "build ms" << "\n";
+
+    for (unsigned threads = 1; threads <= 8; ++threads) {
+        double total_ms = 0;
+
+        for (int frame = 0; frame < timed_frames; ++frame) {
+            offscreen.render([&](Sprite_set& sprites) {
+                Timer timer;
+                sprites.reserve(sprite_count);
+                sprites.add_parallel(sprite_count, threads, build);
+                total_ms += timer.elapsed_time().seconds() * 1000;
+            });
+        }
+
+        cout << setw(10) << threads << setw(12) << fixed << setprecision(3)
+             << total_ms / timed_frames << "\n";
+    }
+}
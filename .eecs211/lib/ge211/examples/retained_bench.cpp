@@ -0,0 +1,142 @@
+// CPU-time benchmark for retained sprites.
+//
+// Draws a scene in which 90% of the sprites never move, either by adding
+// every sprite on every frame or by retaining the static ones. Press `r`
+// to toggle between the two. The average time spent in draw() and the
+// frame rate are printed every few seconds.
+
+#include <ge211.h>
+
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+using namespace ge211;
+using namespace std;
+
+// CONSTANTS
+
+Dimensions const scene_dimensions{1024, 768};
+int const sprite_count{20000};
+double const static_fraction{0.9};
+int const static_layers{4};
+double const report_seconds{3};
+
+// MODEL
+
+struct Model
+{
+    vector<Position> static_positions;
+    vector<Position> moving_positions;
+
+    explicit Model(Random&);
+    void update(Random&);
+};
+
+Model::Model(Random& rng)
+{
+    int static_count = int(sprite_count * static_fraction);
+
+    for (int i = 0; i < sprite_count; ++i) {
+        Position p{rng.up_to(scene_dimensions.width),
+                   rng.up_to(scene_dimensions.height)};
+        if (i < static_count)
+            static_positions.push_back(p);
+        else
+            moving_positions.push_back(p);
+    }
+}
+
+void Model::update(Random& rng)
+{
+    for (Position& p : moving_positions) {
+        p.x = (p.x + rng.between(-2, 2) + scene_dimensions.width)
+              % scene_dimensions.width;
+        p.y = (p.y + rng.between(-2, 2) + scene_dimensions.height)
+              % scene_dimensions.height;
+    }
+}
+
+// MAIN STRUCT AND FUNCTION
+
+struct Retained_bench : Abstract_game
+{
+    Model model{get_random()};
+
+    Rectangle_sprite tile{{4, 4}, Color::medium_green()};
+    Circle_sprite dot{2, Color::medium_red()};
+
+    bool use_retained = true;
+    vector<Sprite_handle> retained;
+
+    Duration draw_time;
+    int draw_count = 0;
+    Timer since_report;
+
+    Dimensions initial_window_dimensions() const override;
+    void on_key(Key key) override;
+    void on_frame(double dt) override;
+    void draw(Sprite_set& sprites) override;
+};
+
+int main()
+{
+    Retained_bench{}.run();
+}
+
+// FUNCTION DEFINITIONS
+
+Dimensions Retained_bench::initial_window_dimensions() const
+{
+    return scene_dimensions;
+}
+
+void Retained_bench::on_key(Key key)
+{
+    if (key == Key::code('r')) {
+        use_retained = !use_retained;
+    } else if (key == Key::code('q')) {
+        quit();
+    }
+}
+
+void Retained_bench::on_frame(double)
+{
+    model.update(get_random());
+
+    if (since_report.elapsed_time().seconds() >= report_seconds) {
+        since_report.reset();
+        cout << (use_retained ? "retained:  " : "immediate: ")
+             << setprecision(4)
+             << 1000 * draw_time.seconds() / draw_count << " ms/draw, "
+             << get_frame_rate() << " fps\n";
+        draw_time = Duration{};
+        draw_count = 0;
+    }
+}
+
+void Retained_bench::draw(Sprite_set& sprites)
+{
+    Timer timer;
+
+    if (use_retained && retained.empty()) {
+        int z = 0;
+        for (Position p : model.static_positions) {
+            int layer = z++ % static_layers;
+            retained.push_back(sprites.add_retained(tile, p, layer));
+        }
+    } else if (!use_retained) {
+        // Dropping the handles removes the retained sprites.
+        retained.clear();
+
+        int z = 0;
+        for (Position p : model.static_positions)
+            sprites.add_sprite(tile, p, z++ % static_layers);
+    }
+
+    for (Position p : model.moving_positions)
+        sprites.add_sprite(dot, p, static_layers);
+
+    draw_time += timer.elapsed_time();
+    ++draw_count;
+}
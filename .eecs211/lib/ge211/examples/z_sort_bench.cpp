@@ -0,0 +1,109 @@
+// Benchmark for sorting sprites by z before painting.
+//
+// Compares the heap that the engine used to drain every frame against
+// detail::sort_by_z, which is stable and, for the handful of z values a
+// typical game uses, linear. This does not open a window.
+
+#include <ge211.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace ge211;
+using namespace std;
+
+using detail::Placed_sprite;
+
+// CONSTANTS
+
+// The z values used by Turret Dodgeball.
+int const z_values[] = {1, 2, 3, 5, 10};
+int const sizes[] = {1000, 10000, 100000};
+int const total_sprites_per_size{10000000};
+
+// A sprite that renders nothing, so the benchmark needs no renderer.
+struct Null_sprite : Sprite
+{
+    Dimensions dimensions() const override { return {1, 1}; }
+
+private:
+    void render(detail::Renderer&, Position, Transform const&) const override
+    { }
+};
+
+// The old paint loop, minus rendering.
+static int drain_heap(vector<Placed_sprite>& sprites)
+{
+    int checksum = 0;
+
+    make_heap(sprites.begin(), sprites.end());
+    while (!sprites.empty()) {
+        pop_heap(sprites.begin(), sprites.end());
+        checksum += sprites.back().z;
+        sprites.pop_back();
+    }
+
+    return checksum;
+}
+
+// The new paint loop, minus rendering.
+static int drain_sorted(vector<Placed_sprite>& sprites,
+                        vector<Placed_sprite>& buffer)
+{
+    int checksum = 0;
+
+    detail::sort_by_z(sprites, buffer);
+    for (Placed_sprite const& sprite : sprites)
+        checksum += sprite.z;
+    sprites.clear();
+
+    return checksum;
+}
+
+int main()
+{
+    Null_sprite sprite;
+    mt19937 rng;
+    int checksum = 0;
+
+    cout << setw(8) << "sprites"
+         << setw(18) << "heap ns/sprite"
+         << setw(18) << "bucket ns/sprite" << "\n";
+
+    for (int size : sizes) {
+        vector<Placed_sprite> input;
+        for (int i = 0; i < size; ++i) {
+            int z = z_values[rng() % (sizeof z_values / sizeof(int))];
+            input.emplace_back(sprite, Position{i, i}, z, Transform{});
+        }
+
+        int rounds = total_sprites_per_size / size;
+        vector<Placed_sprite> sprites, buffer;
+
+        Timer heap_timer;
+        for (int i = 0; i < rounds; ++i) {
+            sprites = input;
+            checksum += drain_heap(sprites);
+        }
+        Duration heap_time = heap_timer.elapsed_time();
+
+        Timer bucket_timer;
+        for (int i = 0; i < rounds; ++i) {
+            sprites = input;
+            checksum += drain_sorted(sprites, buffer);
+        }
+        Duration bucket_time = bucket_timer.elapsed_time();
+
+        double scale = 1e9 / (double(rounds) * size);
+        cout << setw(8) << size
+             << setw(18) << setprecision(3) << heap_time.seconds() * scale
+             << setw(18) << setprecision(3) << bucket_time.seconds() * scale
+             << "\n";
+    }
+
+    // Keeps the work from being optimized away.
+    return checksum == 42;
+}
@@ -1,11 +1,14 @@
 #pragma once
 
 #include "ge211_base.h"
+#include "ge211_camera.h"
 #include "ge211_color.h"
 #include "ge211_error.h"
 #include "ge211_event.h"
 #include "ge211_geometry.h"
 #include "ge211_audio.h"
+#include "ge211_loader.h"
+#include "ge211_offscreen.h"
 #include "ge211_resource.h"
 #include "ge211_random.h"
 #include "ge211_sprites.h"
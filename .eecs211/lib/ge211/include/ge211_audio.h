@@ -4,11 +4,26 @@
 #include "ge211_time.h"
 #include "ge211_util.h"
 
+#include <cstdint>
 #include <memory>
 #include <vector>
 
 namespace ge211 {
 
+namespace detail {
+
+// Ends the frame for the mixer: notices music and effects that have
+// finished, and checks whether the audio thread is running late. The
+// engine calls this once a frame.
+void poll_mixer(audio::Mixer&);
+
+// Checks for underruns as poll_mixer() does once a second, but as though
+// the audio thread had counted `underruns` since the device was opened.
+// Lets tests drive the fallback to larger buffers.
+void check_mixer_underruns(audio::Mixer&, unsigned long underruns);
+
+} // end namespace detail
+
 /// Audio facilities, for playing music and sound effects.
 ///
 /// All audio facilities are accessed via the Mixer, which is in turn
@@ -42,6 +57,9 @@ public:
     ///
     /// Throws exceptions::File_error if the file cannot be opened, and
     /// exceptions::Mixer_error if the file format cannot be understood.
+    ///
+    /// Tracks are cached: while a track loaded from the same file exists,
+    /// this shares it rather than loading the file again.
     Music_track(const std::string& filename, const Mixer&);
 
     /// Default-constructs the empty music track.
@@ -71,7 +89,7 @@ private:
 ///
 /// Note that Sound_effect has few public member functions. However, an
 /// effect track can be passed to the Mixer member function
-/// Mixer::play_effect(Sound_effect, double)
+/// Mixer::play_effect(Sound_effect, double, int)
 /// to play it.
 class Sound_effect
 {
@@ -82,8 +100,22 @@ public:
     ///
     /// Throws exceptions::File_error if the file cannot be opened, and
     /// exceptions::Mixer_error if the file format cannot be understood.
+    ///
+    /// Effects are cached: while an effect loaded from the same file
+    /// exists, this shares it rather than loading the file again.
     Sound_effect(const std::string& filename, const Mixer&);
 
+    /// Makes a sound effect track from samples already in memory.
+    ///
+    /// The samples must be in the format of the Mixer's Audio_profile,
+    /// as returned by Mixer::get_profile(): its sample format, with the
+    /// channels interleaved. The track keeps its own copy.
+    ///
+    /// Throws exceptions::Client_logic_error if `samples` does not hold a
+    /// whole number of sample frames, and exceptions::Mixer_error if the
+    /// track cannot be made.
+    Sound_effect(const std::vector<uint8_t>& samples, const Mixer&);
+
     /// Default-constructs the empty sound effect track.
     Sound_effect() { }
 
@@ -104,6 +136,93 @@ private:
     std::shared_ptr<Mix_Chunk> ptr_;
 };
 
+/// How the Mixer sets up the audio device: its sample rate, sample format,
+/// channel count and buffer size.
+///
+/// The buffer size sets the audio latency: a sound starts playing at most
+/// one buffer after Mixer::play_effect(Sound_effect, double, int) is
+/// called, so 4096 samples at 44.1 kHz is about 93 ms, and 512 samples is
+/// under 12 ms. Small buffers need the audio thread to run on time; if it
+/// doesn't, the device runs out of samples and the sound skips. When the
+/// Mixer detects that happening, it falls back to twice the buffer size,
+/// up to #max_buffer_samples.
+///
+/// The device may not support the requested rate, format or channel
+/// count, in which case the Mixer uses what the device does support (see
+/// Mixer::get_profile() const). Sound_effect%s are converted to the
+/// device's format once, when they are loaded, so playing them never
+/// converts or resamples.
+///
+/// To choose a profile, pass it to Abstract_game's constructor:
+///
+/// ```cpp
+/// struct My_game : Abstract_game
+/// {
+///     My_game()
+///             : Abstract_game(Audio_profile::low_latency())
+///     { }
+/// };
+/// ```
+struct Audio_profile
+{
+    /// How each sample is represented.
+    enum class Format
+    {
+        /// Signed 16-bit integers.
+        int16,
+        /// 32-bit floating point.
+        float32,
+    };
+
+    /// Samples per second, per channel.
+    int frequency = 44100;
+
+    /// How each sample is represented.
+    Format format = Format::int16;
+
+    /// 1 for mono, 2 for stereo.
+    int channels = 2;
+
+    /// Samples per channel in each buffer the device plays. Must be a power
+    /// of two.
+    int buffer_samples = 4096;
+
+    /// The largest buffer to fall back to when the device runs out of
+    /// samples. If this is no larger than #buffer_samples, the Mixer never
+    /// falls back.
+    int max_buffer_samples = 4096;
+
+    /// The latency of one buffer.
+    Duration buffer_latency() const;
+
+    /// The default profile, with 4096-sample buffers.
+    static Audio_profile standard();
+
+    /// A profile for games that need sound to follow the action closely:
+    /// 512-sample buffers at 48 kHz, falling back as far as 4096.
+    static Audio_profile low_latency();
+};
+
+/// Timing of the audio thread, as measured by the Mixer since it last
+/// opened the device. See Mixer::get_audio_stats() const.
+struct Audio_stats
+{
+    /// How many buffers the audio thread has filled.
+    unsigned long callbacks = 0;
+
+    /// How many times the audio thread came back later than half again a
+    /// buffer's length after the previous buffer, which means the device
+    /// probably ran out of samples.
+    unsigned long underruns = 0;
+
+    /// The average time between buffers. This should be about
+    /// Audio_profile::buffer_latency().
+    Duration average_period;
+
+    /// The longest time between two buffers.
+    Duration longest_period;
+};
+
 /// The entity that coordinates playing all audio tracks.
 ///
 /// The mixer is the center of %ge211's audio facilities. It is used to load
@@ -133,12 +252,15 @@ private:
 ///
 /// For playing sound effects, multiple Sound_effect%s can be attached to the
 /// mixer simultaneously. A Sound_effect is attached and played using the
-/// Mixer::play_effect(Sound_effect, double) member function, which also allows
-/// specifying the volume of the sound effect. If nothing further is done, the
-/// sound effect plays to completion and then detaches, making room to attach
-/// more sound effects; however, Mixer::play_effect(Sound_effect, double)
-/// returns a Sound_effect_handle, which can be used to control the sound
-/// effect while it is playing as well.
+/// Mixer::play_effect(Sound_effect, double, int) member function, which also
+/// allows specifying the volume and priority of the sound effect. If nothing
+/// further is done, the sound effect plays to completion and then detaches,
+/// making room to attach more sound effects; however,
+/// Mixer::play_effect(Sound_effect, double, int) returns a
+/// Sound_effect_handle, which can be used to control the sound effect while
+/// it is playing as well. When every channel is busy, a new effect takes the
+/// place of a less important one, so a game can play effects freely without
+/// counting channels.
 class Mixer
 {
 public:
@@ -243,20 +365,53 @@ public:
     ///@{
 
     /// How many effect channels are currently unused? If this is positive,
-    /// then we can play an additional sound effect with
-    /// Mixer::play_effect(Sound_effect, double).
+    /// then Mixer::play_effect(Sound_effect, double, int) can play an
+    /// additional sound effect without stopping another.
     int available_effect_channels() const;
 
-    /// Plays the given effect track on this mixer, at the specified volume.
-    /// The volume must be in the unit interval. Returns a Sound_effect_handle,
-    /// which can be used to control the sound effect while it's playing.
+    /// Plays the given effect track on this mixer, at the specified volume
+    /// and priority. The volume must be in the unit interval. Returns a
+    /// Sound_effect_handle, which can be used to control the sound effect
+    /// while it's playing.
+    ///
+    /// If every channel is busy, the new effect takes over the channel of
+    /// a playing effect whose priority is no higher than its own: the one
+    /// with the lowest priority, then the quietest of those, then the one
+    /// that started first. The effect it replaces stops and detaches.
+    ///
+    /// The effect is not played, and the result is the empty handle, if
+    /// every playing effect has a higher priority, or if the same effect
+    /// has already been started get_effect_rate_limit() times this frame.
+    /// (Many copies of one effect starting together only sound louder.)
+    ///
+    /// This function does not throw, and it does not allocate memory
+    /// unless handles to effects that have already finished are still
+    /// around, so it is cheap to call many times per frame.
     ///
     /// \preconditions
-    ///  - `available_effect_channels() > 0`, throws exceptions::Mixer_error if
-    ///     violated.
     ///  - `!effect.empty()`, undefined behavior if violated.
     Sound_effect_handle
-    play_effect(Sound_effect effect, double volume = 1.0);
+    play_effect(Sound_effect effect, double volume = 1.0, int priority = 0);
+
+    /// The number of times per frame the same effect can be started, unless
+    /// changed with set_effect_rate_limit(int).
+    static const int default_effect_rate_limit;
+
+    /// Sets how many times per frame Mixer::play_effect(Sound_effect,
+    /// double, int) will start the same effect. Further requests to play it
+    /// in that frame are ignored. 0 means no limit.
+    ///
+    /// \preconditions
+    ///  - `per_frame >= 0`, throws exceptions::Client_logic_error if
+    ///    violated.
+    void set_effect_rate_limit(int per_frame);
+
+    /// Returns how many times per frame the same effect can be started; see
+    /// set_effect_rate_limit(int).
+    int get_effect_rate_limit() const
+    {
+        return effect_rate_limit_;
+    }
 
     /// Pauses all currently-playing effects.
     void pause_all_effects();
@@ -266,6 +421,23 @@ public:
 
     ///@}
 
+    ///\name Audio device
+    ///@{
+
+    /// The profile the audio device is actually using, which may differ
+    /// from the one requested if the device doesn't support it, or if the
+    /// Mixer has fallen back to larger buffers.
+    const Audio_profile& get_profile() const noexcept
+    {
+        return profile_;
+    }
+
+    /// Measures how regularly the audio thread has been filling buffers
+    /// since the device was last opened.
+    Audio_stats get_audio_stats() const noexcept;
+
+    ///@}
+
     ///\name Constructors, assignment operators, and destructor
     ///@{
 
@@ -284,41 +456,91 @@ public:
     ///@}
 
 private:
-    /// Opens the mixer, if possible, returning nullptr for failure.
-    static std::unique_ptr<Mixer> open_mixer();
+    /// Opens the mixer with the given profile, if possible, returning
+    /// nullptr for failure.
+    static std::unique_ptr<Mixer> open_mixer(const Audio_profile&);
+
+    /// Opens the audio device, filling in the profile it actually uses.
+    static bool open_device_(Audio_profile&) noexcept;
 
     /// Private constructor -- should not be called, except by Abstract_game.
     // (and if there is more than one Abstract_game at a time, we're in trouble.
-    Mixer();
+    explicit Mixer(const Audio_profile&);
     friend Abstract_game; // constructs.
 
     /// Updates the state of the channels.
     void poll_channels_();
-    friend detail::Engine; // calls poll_channels_().
+    friend void detail::poll_mixer(Mixer&); // calls poll_channels_().
+
+    /// Detaches the effects whose channels have finished playing, as
+    /// reported by SDL_mixer's channel-finished callback.
+    void reclaim_channels_() noexcept;
+
+    /// Returns the index of an empty channel, or -1 if all are busy.
+    int find_empty_channel_() const noexcept;
+
+    /// Returns the channel whose effect should make way for a new one of
+    /// the given priority, or -1 if none should.
+    int find_victim_channel_(int priority) const noexcept;
+
+    /// Starts measuring the audio thread's timing.
+    void start_audio_clock_() noexcept;
 
-    /// Returns the index of an empty channel, or throws if all are full.
-    int find_empty_channel_() const;
+    /// Reopens the device with larger buffers if the audio thread has
+    /// been running late.
+    void check_underruns_();
+
+    /// Does the same given how many underruns the audio thread has
+    /// counted, without waiting for the check period.
+    void check_underruns_(unsigned long underruns);
+    friend void detail::check_mixer_underruns(Mixer&, unsigned long);
+
+    /// Has this effect been started as many times this frame as allowed?
+    bool over_rate_limit_(const Sound_effect&) const noexcept;
 
     /// Registers an effect with a channel.
     Sound_effect_handle
-    register_effect_(int channel, Sound_effect effect);
+    register_effect_(int channel, Sound_effect effect, int priority);
 
     /// Unregisters the effect associated with a channel.
     void unregister_effect_(int channel);
     friend Sound_effect_handle; // calls unregister_effect_(int).
 
 private:
+    // Bookkeeping for choosing which effect to replace.
+    struct Voice_
+    {
+        int priority = 0;
+        // The frame it started on.
+        unsigned long frame = 0;
+        // Effects that started earlier have smaller numbers.
+        unsigned long order = 0;
+    };
+
+    Audio_profile profile_;
+    // When underruns were last checked.
+    Timer underrun_check_;
+    unsigned long underruns_at_check_ = 0;
+
     Music_track current_music_;
     State music_state_{State::detached};
     Pausable_timer music_position_{true};
 
     std::vector<Sound_effect_handle> channels_;
+    std::vector<Voice_> voices_;
+    // Handles of effects that have finished, which can be reused once no
+    // one else holds them.
+    std::vector<Sound_effect_handle> spare_handles_;
     int available_effect_channels_;
+
+    int effect_rate_limit_ = default_effect_rate_limit;
+    unsigned long frame_ = 0;
+    unsigned long next_order_ = 0;
 };
 
 /// Used to control a Sound_effect after it is started playing on a Mixer.
 ///
-/// This is returned by Mixer::play_effect(Sound_effect, double).
+/// This is returned by Mixer::play_effect(Sound_effect, double, int).
 class Sound_effect_handle
 {
 public:
@@ -327,7 +549,7 @@ public:
     /// perform operations on it.
     ///
     /// To get a non-empty Sound_effect_handle, play a Sound_effect with
-    /// Mixer::play_effect(Sound_effect, double).
+    /// Mixer::play_effect(Sound_effect, double, int).
     Sound_effect_handle() {}
 
     /// Recognizes the empty sound effect handle.
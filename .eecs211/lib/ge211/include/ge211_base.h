@@ -13,6 +13,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 namespace ge211 {
 
@@ -95,6 +96,18 @@ class Abstract_game
 {
 public:
 
+    /// Constructs the game, opening the audio device with
+    /// audio::Audio_profile::standard().
+    Abstract_game();
+
+    /// Constructs the game, opening the audio device with the given
+    /// audio::Audio_profile.
+    ///
+    /// Throws exceptions::Client_logic_error if the profile's frequency
+    /// or channel count isn't positive, or if its buffer size isn't a
+    /// power of two.
+    explicit Abstract_game(const audio::Audio_profile&);
+
     /// Runs the game. Usually the way to use this is to create an instance of
     /// your game class in `main` and then call run() on it.
     void run();
@@ -114,6 +127,18 @@ public:
     /// function.
     static const Dimensions default_window_dimensions;
 
+    /// The default target frame rate, in Hz. You can change this with
+    /// set_target_frame_rate(double).
+    static const double default_frame_rate;
+
+    /// While the game is idle, the longest the engine waits for an event
+    /// before running a frame anyway.
+    static const Duration idle_wake_period;
+
+    /// The most time the engine spends before the first frame preparing
+    /// the sprites passed to prepare(const Sprite&) const before then.
+    static const Duration prewarm_budget;
+
 protected:
     /// \name Functions to be overridden by clients
     ///@{
@@ -168,6 +193,16 @@ protected:
     /// Called by the game engine each time the mouse moves.
     virtual void on_mouse_move(Position) { }
 
+    /// Called by the game engine when the game's window loses the focus.
+    /// Until it gets the focus back, the engine treats the game as idle
+    /// (see set_idle(bool)), so override this to pause anything that
+    /// would otherwise move on in the frames it runs when woken.
+    virtual void on_focus_lost() { }
+
+    /// Called by the game engine when the game's window gets the focus
+    /// back after on_focus_lost().
+    virtual void on_focus_gained() { }
+
     /// Called by the game engine after initializing the game but before
     /// commencing the event loop. You can do this to perform initialization
     /// tasks such as preparing sprites::Sprite%s with
@@ -205,6 +240,21 @@ protected:
     /// Causes the event loop to quit after the current frame finishes.
     void quit() noexcept;
 
+    /// Tells the engine whether the game currently has nothing to animate,
+    /// such as on a game-over screen. While the game is idle, the engine
+    /// stops running frames and sleeps until an input event arrives, or
+    /// until idle_wake_period passes. Each time it wakes, it handles the
+    /// events and calls on_frame(double), so the game can react. If there
+    /// were events, or the game is no longer idle, it also calls
+    /// draw(Sprite_set&) and presents the frame; after a wake-up with
+    /// neither, the screen stays as it was. Then it sleeps again, until
+    /// the game calls `set_idle(false)`.
+    void set_idle(bool idle) noexcept;
+
+    /// Whether the game has told the engine it is idle; see set_idle(bool).
+    bool is_idle() const noexcept
+    { return idle_; }
+
     /// Gets the Window that the game is running in. This can be used to query
     /// its size, change its title, etc.
     ///
@@ -234,6 +284,54 @@ protected:
     Duration get_prev_frame_length() const noexcept
     { return prev_frame_length_; }
 
+    /// Returns how much of the previous frame the engine spent working:
+    /// handling events, calling on_frame(double) and draw(Sprite_set&),
+    /// and painting the sprites. Unlike get_prev_frame_length(), this
+    /// leaves out waiting for the display and for the frame pacer, so it
+    /// shows how close the game is to missing its frame rate even while
+    /// it still keeps up.
+    Duration get_prev_frame_busy_time() const noexcept
+    { return prev_frame_busy_time_; }
+
+    /// Sets the frame rate, in Hz, that the engine aims for, such as 60,
+    /// 120 or 144. Pass 0 to run as fast as possible. The default is
+    /// default_frame_rate.
+    ///
+    /// When the display synchronizes frames (vsync), frames come at the
+    /// display's rate regardless; the target rate then only matters if
+    /// synchronization stops, e.g. while the window is hidden.
+    ///
+    /// \preconditions
+    ///  - the rate is not negative
+    void set_target_frame_rate(double hz);
+
+    /// Returns the frame rate, in Hz, that the engine aims for, or 0 if
+    /// uncapped.
+    double get_target_frame_rate() const noexcept
+    { return target_frame_rate_; }
+
+    /// Returns whether the given key is held down. The keyboard is sampled
+    /// once per frame, after the event handlers run and right before
+    /// on_frame(double), so this reflects the latest input available to
+    /// the frame. It is the better way to implement continuous actions,
+    /// such as movement, than tracking on_key_down(Key) and
+    /// on_key_up(Key). Letter keys match regardless of case.
+    bool is_key_down(Key) const noexcept;
+
+    /// Returns when the input event currently being handled actually
+    /// happened, which may be somewhat before its handler is called. This
+    /// is only meaningful inside the event handlers, such as
+    /// on_key_down(Key) and on_mouse_down(Mouse_button, Position).
+    Time_point get_event_time() const noexcept
+    { return event_time_; }
+
+    /// Returns the input-to-present latency of the most recent frame that
+    /// had input: the time from the earliest input event it handled until
+    /// the frame was handed to the display. The display itself may take
+    /// up to another refresh or two to show it.
+    Duration get_input_latency() const noexcept
+    { return input_latency_; }
+
     /// Returns an approximation of the current frame rate in Hz.
     /// Typically we synchronize the frame rate with the video controller, but
     /// accessing it might be useful for diagnosing performance problems.
@@ -249,6 +347,15 @@ protected:
     /// parts of the game smoother. The easiest thing is often to prepare
     /// all sprites you intend to use from an overridden `on_start()`
     /// function.
+    ///
+    /// Sprites passed to this function before the first frame, from the
+    /// game's constructor or from on_start(), are prepared together right
+    /// before the first frame, taking at most prewarm_budget. Any left
+    /// over are prepared when they are first rendered, as usual. Those
+    /// sprites must still exist when the game starts running.
+    ///
+    /// To also move loading and drawing the sprites off the game's
+    /// thread, see Loader.
     void prepare(const sprites::Sprite&) const;
 
     ///@}
@@ -261,17 +368,26 @@ protected:
 private:
     friend detail::Engine;
 
-    void mark_frame_() noexcept;
+    void mark_frame_(Duration busy_time) noexcept;
 
     mutable Random rng_;
     detail::Session session_;
-    std::unique_ptr<audio::Mixer> mixer_ = audio::Mixer::open_mixer();
+    std::unique_ptr<audio::Mixer> mixer_;
     detail::Engine* engine_ = nullptr;
 
     bool quit_ = false;
+    bool idle_ = false;
+
+    // Sprites to prepare right before the first frame.
+    mutable std::vector<const sprites::Sprite*> prewarm_queue_;
+    bool started_ = false;
+    double target_frame_rate_ = default_frame_rate;
 
     Timer frame_start_;
     Duration prev_frame_length_;
+    Duration prev_frame_busy_time_;
+    Time_point event_time_;
+    Duration input_latency_;
     Timer fps_sample_start_;
     int fps_sample_count_{0};
     double fps_{0};
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "ge211_event.h"
+#include "ge211_forward.h"
+#include "ge211_geometry.h"
+#include "ge211_time.h"
+
+#include <array>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+namespace ge211 {
+
+namespace detail {
+
+// One input event from a benchmark script.
+struct Scripted_input
+{
+    enum class Kind
+    {
+        key_down, key_up, mouse_down, mouse_up, mouse_move, quit,
+    };
+
+    int frame = 0;
+    Kind kind = Kind::quit;
+    Key key;
+    Mouse_button button = Mouse_button::left;
+    Position position{0, 0};
+};
+
+// Benchmark mode runs the game loop as fast as it can for a fixed number
+// of frames, with no vsync and no frame pacing, optionally feeding the
+// game input from a script, and then reports how long each phase of the
+// frame took. It is turned on by setting environment variables:
+//
+//   GE211_BENCHMARK=<frames>        how many frames to run
+//   GE211_BENCHMARK_SCRIPT=<path>   optional input script
+//
+// In benchmark mode the session selects SDL's dummy video and audio
+// drivers (unless SDL_VIDEODRIVER or SDL_AUDIODRIVER is already set) and
+// the software renderer, so no GPU or display is needed.
+//
+// A script has one event per line, each starting with the frame on which
+// it happens. Blank lines and lines starting with `#` are ignored:
+//
+//   # frame  event    arguments
+//   10       down     d
+//   70       up       d
+//   80       click    100 200
+//   90       press    100 200
+//   95       release  100 200
+//   100      move     300 40
+//   500      quit
+//
+// Keys are single characters or one of up, down, left, right, space,
+// escape, shift, control, alt and command. `click` presses and releases
+// the left mouse button; `press` and `release` do one or the other.
+class Benchmark
+{
+public:
+    enum Phase
+    {
+        events_phase,
+        update_phase,
+        draw_phase,
+        paint_phase,
+        present_phase,
+        phase_count,
+    };
+
+    // Has benchmark mode been requested through the environment?
+    static bool requested() noexcept;
+
+    // Reads the settings and the script named by the environment. Throws
+    // exceptions::Client_logic_error if they are malformed.
+    Benchmark();
+
+    // Calls `deliver` on each scripted input for the current frame.
+    template <class FN>
+    void play_input(FN deliver)
+    {
+        while (next_input_ < script_.size() &&
+               script_[next_input_].frame <= frame_) {
+            deliver(script_[next_input_++]);
+        }
+    }
+
+    // Records the time since the previous phase ended as the time taken
+    // by the given phase of the current frame.
+    void end_phase(Phase) noexcept;
+
+    // Finishes the current frame, and returns whether that was the last
+    // frame to run.
+    bool end_frame();
+
+    // Prints frames per second, per-phase averages and the worst frames.
+    void report(std::ostream&) const;
+
+    static const char* phase_name(Phase);
+
+private:
+    using Sample = std::array<double, phase_count>;
+
+    int frame_count_;
+    std::vector<Scripted_input> script_;
+    size_t next_input_ = 0;
+
+    int frame_ = 0;
+    Sample current_{};
+    std::vector<Sample> samples_;
+
+    Timer total_timer_;
+    Timer phase_timer_;
+    Duration total_time_;
+};
+
+} // end namespace detail
+
+}
@@ -0,0 +1,262 @@
+#pragma once
+
+#include "ge211_error.h"
+#include "ge211_forward.h"
+#include "ge211_geometry.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace ge211 {
+
+namespace geometry {
+
+/// Maps a world that may be larger than the window onto a rectangle of
+/// the screen, its *viewport*, with panning and zooming.
+///
+/// A game that uses a Camera keeps its model in world coordinates and
+/// converts positions with to_screen(Position) const only when drawing.
+/// Because Transform scales a sprite from its top-left corner, a sprite
+/// at world position `p` is drawn at `to_screen(p)` with transform()
+/// applied:
+///
+/// ```cpp
+/// sprites.add_sprite(ball_sprite, camera.to_screen(ball.top_left()),
+///                    1, camera.transform());
+/// ```
+///
+/// A new camera has a zoom of 1 and shows the world rectangle that
+/// coincides with its viewport, so world and screen coordinates agree
+/// until the camera is moved.
+class Camera
+{
+public:
+    /// Constructs a camera that draws into the given rectangle of the
+    /// screen.
+    ///
+    /// \preconditions
+    ///  - Both dimensions of the viewport are positive, throws
+    ///    exceptions::Client_logic_error if violated.
+    explicit Camera(Rectangle viewport);
+
+    /// \name Setters
+    /// @{
+
+    /// Centers the view on the given world position.
+    Camera& set_center(Basic_position<double>) noexcept;
+
+    /// Moves the view by the given distance in world units.
+    Camera& pan(Basic_dimensions<double>) noexcept;
+
+    /// Sets how many screen pixels one world unit takes up, keeping the
+    /// same center. Greater than 1 zooms in.
+    ///
+    /// \preconditions
+    ///  - The zoom is positive, throws exceptions::Client_logic_error if
+    ///    violated.
+    Camera& set_zoom(double);
+
+    /// Moves the center as little as possible so that the view doesn't
+    /// extend past the given world rectangle. If the view is wider or
+    /// taller than the rectangle, it is centered on the rectangle in that
+    /// dimension instead.
+    Camera& keep_within(Rectangle world) noexcept;
+
+    /// @}
+
+    /// \name Getters
+    /// @{
+
+    /// The world position at the center of the view.
+    Basic_position<double> get_center() const noexcept { return center_; }
+
+    /// Screen pixels per world unit.
+    double get_zoom() const noexcept { return zoom_; }
+
+    /// The rectangle of the screen the camera draws into.
+    Rectangle get_viewport() const noexcept { return viewport_; }
+
+    /// @}
+
+    /// The smallest world rectangle containing everything in view.
+    Rectangle visible_area() const noexcept;
+
+    /// Could any of the given world rectangle be in view?
+    bool can_see(Rectangle world) const noexcept;
+
+    /// Converts a world position to the screen.
+    Position to_screen(Position world) const noexcept;
+
+    /// Converts a screen position, such as the mouse's, to the world.
+    Position to_world(Position screen) const noexcept;
+
+    /// The transform that scales sprites by the zoom.
+    Transform transform() const noexcept;
+
+private:
+    // The world position at the top-left of the viewport.
+    Basic_position<double> world_top_left_() const noexcept;
+
+    Rectangle viewport_;
+    Basic_position<double> center_;
+    double zoom_ = 1;
+};
+
+/// Do two rectangles overlap? Rectangles that only share an edge don't.
+inline bool overlap(Rectangle r1, Rectangle r2) noexcept
+{
+    return r1.x < r2.x + r2.width && r2.x < r1.x + r1.width &&
+           r1.y < r2.y + r2.height && r2.y < r1.y + r1.height;
+}
+
+/// Finds the values whose bounding rectangles overlap an area, such as
+/// the entities a Camera can see, without testing every one.
+///
+/// The grid divides a rectangle of the world into square cells and
+/// files each value under every cell its bounds overlap. A query only
+/// looks at the values in the cells the area overlaps, so its cost
+/// depends on how much of the world the area covers and how crowded it
+/// is, not on the size of the world. Values outside the grid's rectangle
+/// are filed under the nearest cells along its edge, so they are still
+/// found.
+///
+/// The grid holds values of type `T`, usually small ones such as indices
+/// into the game's own lists. For entities that move every frame, clear()
+/// the grid and insert them again before querying; clearing keeps the
+/// grid's memory for reuse.
+template <class T>
+class Spatial_grid
+{
+public:
+    /// Constructs an empty grid covering the given world rectangle with
+    /// cells of the given size. Cells about as large as the biggest
+    /// entity, or a few times larger, work best.
+    ///
+    /// \preconditions
+    ///  - The rectangle and the cell size are positive, throws
+    ///    exceptions::Client_logic_error if violated.
+    Spatial_grid(Rectangle world, int cell_size)
+            : world_{world}
+            , cell_size_{cell_size}
+    {
+        if (world.width <= 0 || world.height <= 0 || cell_size <= 0)
+            throw Client_logic_error{"Spatial_grid: size must be positive"};
+
+        columns_ = (world.width + cell_size - 1) / cell_size;
+        rows_ = (world.height + cell_size - 1) / cell_size;
+        cells_.resize(size_t(columns_) * rows_);
+    }
+
+    /// Removes every value.
+    void clear() noexcept
+    {
+        for (uint32_t cell : used_cells_)
+            cells_[cell].clear();
+        used_cells_.clear();
+        entries_.clear();
+    }
+
+    /// Makes room for the given number of values.
+    void reserve(size_t count)
+    {
+        entries_.reserve(count);
+    }
+
+    /// The number of values in the grid.
+    size_t size() const noexcept
+    {
+        return entries_.size();
+    }
+
+    /// Adds a value with the given bounding rectangle.
+    void insert(Rectangle bounds, T value)
+    {
+        auto index = uint32_t(entries_.size());
+        entries_.push_back({bounds, std::move(value)});
+
+        Range_ range = cells_of_(bounds);
+        for (int row = range.top; row <= range.bottom; ++row) {
+            for (int column = range.left; column <= range.right; ++column) {
+                uint32_t cell = uint32_t(row * columns_ + column);
+                if (cells_[cell].empty()) used_cells_.push_back(cell);
+                cells_[cell].push_back(index);
+            }
+        }
+    }
+
+    /// Calls `visit` with each value whose bounds overlap the given area,
+    /// once each, in no particular order.
+    template <class VISIT>
+    void query(Rectangle area, VISIT visit) const
+    {
+        Range_ range = cells_of_(area);
+
+        for (int row = range.top; row <= range.bottom; ++row) {
+            for (int column = range.left; column <= range.right; ++column) {
+                for (uint32_t index : cells_[row * columns_ + column]) {
+                    const Entry_& entry = entries_[index];
+
+                    // A value in several cells is visited only from the
+                    // first of them that the query also covers.
+                    Range_ own = cells_of_(entry.bounds);
+                    if (column != std::max(own.left, range.left) ||
+                        row != std::max(own.top, range.top))
+                        continue;
+
+                    if (overlap(entry.bounds, area)) visit(entry.value);
+                }
+            }
+        }
+    }
+
+private:
+    struct Entry_
+    {
+        Rectangle bounds;
+        T value;
+    };
+
+    // An inclusive range of cells.
+    struct Range_
+    {
+        int left, top, right, bottom;
+    };
+
+    int column_of_(int x) const noexcept
+    {
+        int column = x < world_.x ? 0 : (x - world_.x) / cell_size_;
+        return std::min(column, columns_ - 1);
+    }
+
+    int row_of_(int y) const noexcept
+    {
+        int row = y < world_.y ? 0 : (y - world_.y) / cell_size_;
+        return std::min(row, rows_ - 1);
+    }
+
+    Range_ cells_of_(Rectangle r) const noexcept
+    {
+        // The last pixel inside, since rectangles don't include their
+        // right and bottom edges.
+        return {column_of_(r.x),
+                row_of_(r.y),
+                column_of_(r.x + std::max(r.width, 1) - 1),
+                row_of_(r.y + std::max(r.height, 1) - 1)};
+    }
+
+    Rectangle world_;
+    int cell_size_;
+    int columns_;
+    int rows_;
+
+    std::vector<Entry_> entries_;
+    // Indices into entries_, by cell, row by row.
+    std::vector<std::vector<uint32_t>> cells_;
+    // The cells that aren't empty, so clear() doesn't visit the rest.
+    std::vector<uint32_t> used_cells_;
+};
+
+} // end namespace geometry
+
+}
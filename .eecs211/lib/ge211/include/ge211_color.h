@@ -317,5 +317,18 @@ private:
     uint32_t to_sdl_(const SDL_PixelFormat*) const noexcept;
 };
 
+/// Equality for colors, which compares all four components.
+inline bool operator==(Color c1, Color c2) noexcept
+{
+    return c1.red() == c2.red() && c1.green() == c2.green() &&
+           c1.blue() == c2.blue() && c1.alpha() == c2.alpha();
+}
+
+/// Disequality for colors.
+inline bool operator!=(Color c1, Color c2) noexcept
+{
+    return !(c1 == c2);
+}
+
 }
 
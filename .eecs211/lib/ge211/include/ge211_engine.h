@@ -1,13 +1,48 @@
 #pragma once
 
+#include "ge211_event.h"
 #include "ge211_forward.h"
 #include "ge211_render.h"
+#include "ge211_time.h"
 #include "ge211_window.h"
 
+#include <cstdint>
+#include <vector>
+
 namespace ge211 {
 
 namespace detail {
 
+// Waits out the remainder of each frame so that frames start at a steady
+// rate. Sleeping alone is imprecise, since the scheduler may wake us
+// several milliseconds late, so the pacer sleeps until shortly before
+// the deadline and then yields until the deadline actually arrives.
+//
+// Each deadline is the previous deadline plus one frame, not the end of
+// the previous frame plus one frame, so lateness doesn't accumulate.
+class Frame_pacer
+{
+public:
+    // How long before each deadline the pacer stops sleeping and starts
+    // yielding.
+    static const Duration spin_margin;
+
+    Frame_pacer() noexcept;
+
+    // Waits until the end of the current frame, given the length of a
+    // frame, and returns how long it waited. A frame length of zero
+    // means uncapped: it does not wait at all.
+    Duration wait(Duration frame_length);
+
+    // Starts the schedule over from now. Call this after a pause, so
+    // that the pacer doesn't try to catch up.
+    void reset() noexcept;
+
+private:
+    // The scheduled start of the current frame.
+    Time_point deadline_;
+};
+
 class Engine
 {
 public:
@@ -15,18 +50,52 @@ public:
 
     void run();
     void prepare(const sprites::Sprite&) const;
+    bool is_key_down(Key) const noexcept;
     Window& get_window() noexcept;
 
     ~Engine();
 
 private:
-    void handle_events_(SDL_Event&);
-    void paint_sprites_(Sprite_set&);
+    // Delivers the queued events to the game, returning whether there
+    // were any.
+    bool handle_events_(SDL_Event&);
+    // Records the SDL timestamp of an input event as the game's event
+    // time, and as the start of this frame's input latency if it is the
+    // first input of the frame.
+    void note_input_(uint32_t timestamp) noexcept;
+    // Takes the keyboard snapshot that is_key_down consults.
+    void latch_keyboard_();
+    // Records the latency of a frame that has just been presented.
+    void measure_latency_() noexcept;
+    // Whether the game has said it is idle, or its window has lost the
+    // focus.
+    bool is_idle_() const noexcept;
+    // Sleeps until there is an event or until the idle wake period has
+    // passed.
+    void wait_while_idle_();
+    // Prepares the sprites the game asked to prepare before the first
+    // frame, for up to Abstract_game::prewarm_budget.
+    void prewarm_();
+
+    // Delivers input from a benchmark script to the game.
+    void play_input_(const Scripted_input&);
 
     Abstract_game& game_;
     Window window_;
     detail::Renderer renderer_;
+    Frame_pacer pacer_;
     bool is_focused_ = false;
+    // Set by losing the focus, rather than by not having gained it yet,
+    // so that a window that never gets the focus (e.g. with SDL's dummy
+    // video driver) still runs.
+    bool focus_lost_ = false;
+
+    std::vector<uint8_t> keyboard_;
+    // Keys held down by a benchmark script.
+    std::vector<Key> scripted_keys_;
+
+    bool frame_has_input_ = false;
+    Time_point first_input_time_;
 };
 
 } // end namespace detail
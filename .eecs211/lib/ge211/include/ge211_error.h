@@ -95,6 +95,8 @@ class Host_error : public Environment_error
     friend Mixer_error;
 
     /// Throwers
+    friend Rgba_image;
+    friend Sprite_atlas;
     friend Text_sprite;
     friend Window;
     friend detail::Renderer;
@@ -128,8 +130,9 @@ class Image_error final : public Host_error
     explicit Image_error(const std::string& message);
     static Image_error could_not_load(const std::string& filename);
 
-    /// Thrower
+    /// Throwers
     friend Image_sprite;
+    friend Rgba_image;
 };
 
 /// Indicates an error in the mixer, which could include the inability to
@@ -139,6 +142,7 @@ class Mixer_error : public Host_error
     Mixer_error(const std::string& message);
     static Mixer_error could_not_load(const std::string& filename);
     static Mixer_error out_of_channels();
+    static Mixer_error could_not_load_samples();
 
     /// Thrower
     friend Mixer;
@@ -148,6 +152,14 @@ class Mixer_error : public Host_error
 
 } // end namespace exception
 
+// Log messages below this level are removed at compile time: 0 keeps
+// them all, 1 removes debug messages, 2 removes info messages too, and 3
+// removes warnings too. Fatal messages are always kept. The build sets
+// this for the library and everything that links it, so they agree.
+#ifndef GE211_MIN_LOG_LEVEL
+#   define GE211_MIN_LOG_LEVEL 0
+#endif
+
 namespace detail {
 
 enum class Log_level
@@ -158,8 +170,14 @@ enum class Log_level
     fatal,
 };
 
-// Right now a Logger just keeps track of the current log
-// level, and there's only one Logger (Singleton Pattern).
+// There's only one Logger (Singleton Pattern). It keeps track of the
+// current log level and writes finished messages to `std::cerr`.
+//
+// Writing is asynchronous: messages go into a fixed-size ring buffer,
+// which threads add to without locking, and a background thread drains
+// it. If the buffer is full, messages are dropped (and counted) rather
+// than making the caller wait. Fatal messages are written synchronously,
+// after everything before them, since the program is about to exit.
 class Logger
 {
 public:
@@ -170,6 +188,19 @@ public:
 
     static Logger& instance() noexcept;
 
+    // Queues a finished message, which should end in a newline.
+    void write(const std::string&) noexcept;
+
+    // Writes a message after all the queued messages, and doesn't
+    // return until it has been written.
+    void write_now(const std::string&) noexcept;
+
+    // Doesn't return until every queued message has been written.
+    void flush() noexcept;
+
+    // How many messages have been dropped because the buffer was full.
+    unsigned long dropped() const noexcept;
+
 private:
     Logger() noexcept = default;
 
@@ -208,16 +239,49 @@ public:
 private:
     std::string reason_;
     std::ostringstream message_;
+    Level level_;
     bool active_;
 };
 
+// Stands in for a Log_message whose level is removed at compile time.
+// Everything streamed into it is discarded, so the compiler can remove
+// the whole statement.
+class Null_log_message
+{
+public:
+    template <class T>
+    Null_log_message& operator<<(const T&) noexcept
+    {
+        return *this;
+    }
+};
+
+#if GE211_MIN_LOG_LEVEL > 0
+template <class... ARGS>
+inline Null_log_message debug(const ARGS&...) noexcept { return {}; }
+#else
 Log_message debug(std::string reason = "");
-Log_message info(std::string reason = "");
-Log_message warn(std::string reason = "");
-Log_message fatal(std::string reason = "");
+#endif
 
+#if GE211_MIN_LOG_LEVEL > 1
+template <class... ARGS>
+inline Null_log_message info(const ARGS&...) noexcept { return {}; }
+inline Null_log_message info_sdl() noexcept { return {}; }
+#else
+Log_message info(std::string reason = "");
 Log_message info_sdl();
+#endif
+
+#if GE211_MIN_LOG_LEVEL > 2
+template <class... ARGS>
+inline Null_log_message warn(const ARGS&...) noexcept { return {}; }
+inline Null_log_message warn_sdl() noexcept { return {}; }
+#else
+Log_message warn(std::string reason = "");
 Log_message warn_sdl();
+#endif
+
+Log_message fatal(std::string reason = "");
 Log_message fatal_sdl();
 
 } // end namespace detail
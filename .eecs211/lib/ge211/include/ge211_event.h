@@ -34,6 +34,11 @@ namespace detail {
 // not correspond to left, middle, or right.
 bool map_button(uint8_t, Mouse_button&) noexcept;
 
+// Looks up whether a key is held down in a keyboard state array of the
+// given length, as returned by SDL_GetKeyboardState. Letter keys match
+// regardless of case.
+bool is_key_down(Key, const uint8_t* state, int length) noexcept;
+
 // Unicode constants.
 static char32_t const lowest_unicode_surrogate = 0xD800;
 static char32_t const highest_unicode_surrogate = 0xDFFF;
@@ -20,16 +20,26 @@ namespace ge211 {
 class Abstract_game;
 class Color;
 class Font;
+class Loader;
+class Offscreen_renderer;
+struct Rgba_image;
+class Sprite_handle;
+class Sprite_list;
 class Sprite_set;
 class Window;
 
 /// Internal implementation details.
 namespace detail {
 
+class Benchmark;
 class Engine;
 class File_resource;
+class Frame_pacer;
 struct Placed_sprite;
+class Recorder;
 class Renderer;
+struct Retained_sprite;
+struct Scripted_input;
 class Session;
 class Render_sprite;
 class Texture;
@@ -39,6 +49,8 @@ class Texture_sprite;
 
 namespace audio {
 
+struct Audio_profile;
+struct Audio_stats;
 enum class Channel_state;
 class Mixer;
 class Music_track;
@@ -77,6 +89,8 @@ template <class> struct Basic_rectangle;
 using Dimensions = Basic_dimensions<int>;
 using Position = Basic_position<int>;
 using Rectangle = Basic_rectangle<int>;
+class Camera;
+template <class> class Spatial_grid;
 class Transform;
 
 } // end namespace geometry
@@ -85,10 +99,13 @@ namespace sprites {
 
 class Sprite;
 
+class Circle_batch_sprite;
 class Circle_sprite;
 class Image_sprite;
+class Layer_sprite;
 class Multiplexed_sprite;
 class Rectangle_sprite;
+class Sprite_atlas;
 class Text_sprite;
 
 } // end namespace sprites
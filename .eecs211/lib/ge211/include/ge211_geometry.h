@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ge211_color.h"
 #include "ge211_forward.h"
 #include "ge211_util.h"
 
@@ -522,8 +523,10 @@ struct Basic_rectangle
 
 private:
     friend Circle_sprite;
+    friend Sprite_atlas;
     friend detail::Render_sprite;
     friend detail::Renderer;
+    friend detail::Texture;
 
     /// Converts this rectangle to an internal SDL rectangle.
     operator SDL_Rect() const
@@ -654,7 +657,7 @@ private:
     Coordinate  y_end_;
 };
 
-/// A rendering transform, which can scale, flip, and rotate. A Transform
+/// A rendering transform, which can scale, flip, rotate, and tint. A Transform
 /// can be given to
 /// Sprite_set::add_sprite(const Sprite&, Position, int, const Transform&)
 /// to specify how a sprites::Sprite should be rendered.
@@ -668,6 +671,7 @@ private:
 ///   - Transform::scale(double)
 ///   - Transform::scale_x(double)
 ///   - Transform::scale_y(double)
+///   - Transform::tint(Color)
 ///
 /// It is also possible to modify a transform with the setter functions
 /// such as set_rotation(double) and set_scale(double). This can be used
@@ -680,6 +684,19 @@ private:
 ///                .scale_x(2);
 /// ```
 ///
+/// A tint multiplies the color of every pixel by a Color, so that one
+/// white sprite can be drawn in any color, and fades it by the Color's
+/// alpha. Since tinting doesn't need a texture of its own, it is a cheap
+/// way to draw many variations of one sprite:
+///
+/// ```cpp
+/// Circle_sprite ball{5, Color::white()};
+/// ...
+/// sprites.add_sprite(ball, red_ball, 1, Transform::tint(Color{255, 0, 0}));
+/// sprites.add_sprite(ball, fading_ball, 1,
+///                    Transform::tint(Color::white().fade_out(0.5)));
+/// ```
+///
 class Transform
 {
 public:
@@ -708,6 +725,9 @@ public:
     /// Constructs a transform that scales the sprite in the *y* dimension.
     static Transform scale_y(double) noexcept;
 
+    /// Constructs a transform that tints the sprite with the given color.
+    static Transform tint(Color) noexcept;
+
     /// @}
 
     /// \name Setters
@@ -732,6 +752,10 @@ public:
     /// overwrites the effect of previous calls to `set_scale(double)`
     /// as well as itself.
     Transform& set_scale_y(double) noexcept;
+    /// Modifies this transform to multiply the red, green, blue and alpha
+    /// of every pixel by those of the given color, as fractions of 255.
+    /// Tinting with Color::white() has no effect.
+    Transform& set_tint(Color) noexcept;
 
     /// @}
 
@@ -748,6 +772,8 @@ public:
     double get_scale_x() const noexcept;
     /// Returns how much the sprite will be scaled vertically.
     double get_scale_y() const noexcept;
+    /// Returns the color the sprite will be tinted with.
+    Color get_tint() const noexcept;
 
     /// @}
 
@@ -760,13 +786,19 @@ public:
     /// for any transform constructed by the default constructor Transform().
     bool is_identity() const noexcept;
 
-    /// Composes two transforms to combine both of their effects.
+    /// Composes two transforms to combine both of their effects. Their
+    /// tints multiply together.
     Transform operator*(const Transform&) const noexcept;
 
+    /// Is this transformation free of scaling, flipping and rotation? It
+    /// may still tint.
+    bool is_untransformed() const noexcept;
+
     /// Returns the inverse of this transform. Composing a transform with its
     /// inverse should result in the identity transformation, though because
     /// floating point is approximate, is_identity() const may not actually
-    /// answer `true`.
+    /// answer `true`. A tint can't be undone once it has darkened a color,
+    /// so the inverse has no tint.
     Transform inverse() const noexcept;
 
     /// @}
@@ -775,6 +807,7 @@ private:
     double rotation_;
     double scale_x_;
     double scale_y_;
+    Color tint_;
     bool flip_h_;
     bool flip_v_;
 };
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "ge211_color.h"
+#include "ge211_forward.h"
+#include "ge211_geometry.h"
+#include "ge211_resource.h"
+#include "ge211_sprites.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ge211 {
+
+/// Loads assets on background threads, so that parsing fonts, decoding
+/// images and drawing shapes doesn't hold up the game's thread.
+///
+/// Each load function returns right away with a `std::future` for the
+/// result. Call its `get()` member function when you need the result,
+/// which waits if it isn't ready yet, and throws whatever exception
+/// loading threw.
+///
+/// For example, a game might start loading its assets when it is
+/// constructed, and then prepare them for rendering from on_start(). A
+/// `std::shared_future` lets the game keep using the loaded sprite:
+///
+/// ```cpp
+/// struct My_game : Abstract_game
+/// {
+///     Loader loader;
+///     std::shared_future<Image_sprite> logo =
+///             loader.load_image("logo.png").share();
+///
+///     void on_start() override
+///     {
+///         prepare(logo.get());
+///     }
+///
+///     void draw(Sprite_set& sprites) override
+///     {
+///         sprites.add_sprite(logo.get(), Position{100, 100});
+///     }
+/// };
+/// ```
+///
+/// Loading only produces an image in memory; it still has to be sent to
+/// the graphics card before it can be drawn, which can only happen on the
+/// game's thread. See Abstract_game::prepare(const Sprite&) const for
+/// doing that ahead of time.
+///
+/// Unlike most of %ge211, a Loader can be constructed before the game
+/// is, but the assets it loads still need the game to exist.
+class Loader
+{
+public:
+    /// The number of background threads a Loader starts by default: one
+    /// fewer than the number of processors, but at least one.
+    static unsigned default_thread_count() noexcept;
+
+    /// Starts a loader with the given number of background threads.
+    explicit Loader(unsigned thread_count = default_thread_count());
+
+    /// Finishes all the loading already requested, and then stops the
+    /// background threads.
+    ~Loader();
+
+    Loader(const Loader&) = delete;
+    Loader& operator=(const Loader&) = delete;
+
+    /// Loads a Font on a background thread.
+    std::future<Font> load_font(const std::string& filename, int size);
+
+    /// Loads and decodes an image on a background thread.
+    std::future<sprites::Image_sprite>
+    load_image(const std::string& filename);
+
+    /// Draws a Circle_sprite on a background thread.
+    std::future<sprites::Circle_sprite> make_circle(int radius, Color);
+
+    /// Draws a Rectangle_sprite on a background thread.
+    std::future<sprites::Rectangle_sprite> make_rectangle(Dimensions, Color);
+
+    /// Runs any function on a background thread, returning a future for
+    /// its result.
+    ///
+    /// The function must be safe to run on another thread. Loading
+    /// resources and creating sprites, other than Circle_batch_sprite%s
+    /// and Layer_sprite%s, is; using the Mixer, the Window or the
+    /// game's Random generator is not.
+    template <class FN>
+    auto run(FN job) -> std::future<decltype(job())>
+    {
+        using Result = decltype(job());
+        auto task = std::make_shared<std::packaged_task<Result()>>(
+                std::move(job));
+        std::future<Result> result = task->get_future();
+        submit_([task] { (*task)(); });
+        return result;
+    }
+
+    /// Waits until everything requested so far has finished loading.
+    void wait();
+
+    /// How many requests are waiting or still being worked on.
+    size_t pending() const;
+
+private:
+    void submit_(std::function<void()>);
+    void work_();
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_ready_;
+    std::condition_variable all_done_;
+    std::deque<std::function<void()>> queue_;
+    size_t running_ = 0;
+    bool stopping_ = false;
+
+    std::vector<std::thread> threads_;
+};
+
+}
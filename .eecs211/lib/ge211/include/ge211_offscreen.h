@@ -0,0 +1,128 @@
+#pragma once
+
+#include "ge211_color.h"
+#include "ge211_forward.h"
+#include "ge211_geometry.h"
+#include "ge211_render.h"
+#include "ge211_session.h"
+#include "ge211_sprites.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ge211 {
+
+/// A copy of an image's pixels, for saving rendered frames and comparing
+/// them. Each pixel is 4 bytes, in the order red, green, blue, alpha,
+/// row by row from the top-left with no padding between rows.
+struct Rgba_image
+{
+    /// The width and height in pixels.
+    Dimensions dimensions{0, 0};
+
+    /// `4 * dimensions.width * dimensions.height` bytes.
+    std::vector<uint8_t> pixels;
+
+    /// The color of one pixel.
+    ///
+    /// \preconditions
+    ///  - The position is within #dimensions, throws
+    ///    exceptions::Client_logic_error if violated.
+    Color get_pixel(Position) const;
+
+    /// Loads an image file from the given path (not from the resource
+    /// directories, as for an Image_sprite).
+    ///
+    /// Throws exceptions::Image_error if the file cannot be loaded.
+    static Rgba_image load(const std::string& path);
+
+    /// Saves the image as a PNG file at the given path.
+    ///
+    /// Throws exceptions::Host_error if the file cannot be written.
+    void save_png(const std::string& path) const;
+};
+
+/// Renders Sprite_set%s into pixels in memory rather than to a window, so
+/// that drawing code can run where there is no display: in tests, in
+/// benchmarks, or to produce images.
+///
+/// It draws in software, so reading the pixels back is just reading
+/// memory, and never waits for a graphics card.
+///
+/// For example, this renders a view and checks the color at its center:
+///
+/// ```cpp
+/// Offscreen_renderer offscreen(Dimensions{800, 600});
+/// offscreen.render([&](Sprite_set& sprites) { view.draw(sprites); });
+/// CHECK(offscreen.get_pixel({400, 300}) == Color::medium_red());
+/// ```
+///
+/// An Offscreen_renderer can be used with or without an Abstract_game, but
+/// a Sprite can only be rendered by one of them or the other.
+class Offscreen_renderer
+{
+public:
+    /// Creates an offscreen renderer with a framebuffer of the given
+    /// dimensions, initially transparent black.
+    ///
+    /// Throws exceptions::Host_error if the framebuffer cannot be
+    /// allocated.
+    explicit Offscreen_renderer(Dimensions);
+
+    /// Renders one frame. Calls `draw` with the Sprite_set to fill in,
+    /// just as the engine calls Abstract_game::draw(Sprite_set&), and
+    /// then renders the sprites on top of #background_color.
+    ///
+    /// As with a game, sprites added with Sprite_set::add_retained()
+    /// stay for later frames, and the rest are rendered only once.
+    template <class DRAW>
+    void render(DRAW draw)
+    {
+        draw(sprites_);
+        paint_();
+    }
+
+    /// Prepares a sprite for rendering, without actually rendering it.
+    /// Rendering prepares sprites as needed, so this is only to get the
+    /// work out of the way ahead of time.
+    void prepare(const sprites::Sprite&) const;
+
+    /// The dimensions of the framebuffer.
+    Dimensions get_dimensions() const noexcept;
+
+    /// The color of one pixel of the latest frame.
+    ///
+    /// \preconditions
+    ///  - The position is within get_dimensions(), throws
+    ///    exceptions::Client_logic_error if violated.
+    Color get_pixel(Position) const;
+
+    /// The pixels of the latest frame, 4 bytes each, in the order red,
+    /// green, blue, alpha. The first is the top-left pixel, and each row
+    /// starts get_pitch() bytes after the previous one. The pointer stays
+    /// valid for as long as the Offscreen_renderer does, and the pixels
+    /// change only when rendering.
+    const uint8_t* get_pixels() const noexcept;
+
+    /// The distance in bytes between the starts of consecutive rows of
+    /// get_pixels(), which may be more than 4 times the width.
+    int get_pitch() const noexcept;
+
+    /// Copies the latest frame.
+    Rgba_image snapshot() const;
+
+    /// The color to fill the framebuffer with before rendering each
+    /// frame's sprites. Like Abstract_game::background_color, it starts
+    /// out black.
+    Color background_color = Color::black();
+
+private:
+    void paint_();
+
+    detail::Session session_{detail::Session::Mode::headless};
+    detail::Renderer renderer_;
+    Sprite_set sprites_;
+};
+
+}
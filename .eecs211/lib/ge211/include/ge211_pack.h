@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ge211 {
+
+namespace detail {
+
+// A resource pack holds many resource files in a single file that is
+// mapped into memory at startup, so resources can be read in place
+// without opening and reading files one at a time. Packs are built by the
+// `ge211_pack` tool; see `add_resource_pack` in the CMake configuration.
+//
+// Format (all integers little-endian):
+//
+//   header      "GE211PAK", u32 version (1), u32 entry count
+//   directory   one 24-byte entry per file, sorted by name:
+//                 u64 data offset, u64 data size,
+//                 u32 name offset, u32 name size
+//   names       the file names, not NUL-terminated
+//   data        each file's contents, starting at a multiple of
+//               pack_alignment
+//
+// Offsets are from the start of the pack.
+class Resource_pack
+{
+public:
+    static const char magic[8];
+    static const uint32_t version = 1;
+    static const size_t header_size = 16;
+    static const size_t entry_size = 24;
+    static const size_t pack_alignment = 16;
+
+    // The name the engine looks for pack files under, in the working
+    // directory and its parent, unless the GE211_RESOURCE_PACK
+    // environment variable names a pack.
+    static const char* const default_filename;
+
+    // The pack found at startup, or nullptr if there is none. The first
+    // call opens it.
+    static const Resource_pack* get();
+
+    // Maps the pack at the given path. If it cannot be opened or is not a
+    // valid pack, the result is empty().
+    explicit Resource_pack(const std::string& path);
+
+    ~Resource_pack();
+
+    Resource_pack(const Resource_pack&) = delete;
+    Resource_pack& operator=(const Resource_pack&) = delete;
+
+    bool empty() const noexcept { return count_ == 0; }
+
+    // Finds the named file, setting `data` and `size` to its contents,
+    // which remain valid as long as the pack does.
+    bool find(const std::string& name,
+              const unsigned char*& data, size_t& size) const noexcept;
+
+    // The names of the files in the pack, in sorted order.
+    std::vector<std::string> names() const;
+
+private:
+    struct Entry_
+    {
+        uint64_t data_offset;
+        uint64_t data_size;
+        uint32_t name_offset;
+        uint32_t name_size;
+    };
+
+    Entry_ entry_(size_t index) const noexcept;
+    bool validate_() const noexcept;
+    void unmap_() noexcept;
+
+    const unsigned char* base_ = nullptr;
+    size_t size_ = 0;
+    size_t count_ = 0;
+
+    // When the pack could not be memory-mapped, it is read into here.
+    std::vector<unsigned char> fallback_;
+    bool mapped_ = false;
+};
+
+} // end namespace detail
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include "ge211_forward.h"
+#include "ge211_offscreen.h"
+
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ge211 {
+
+namespace detail {
+
+// Records every frame the engine renders, for highlights and bug reports.
+// It is turned on by setting environment variables:
+//
+//   GE211_RECORD=<path>           where to record; see below
+//   GE211_RECORD_BUFFERS=<n>      optional number of frame buffers (8)
+//
+// If the path ends in `.y4m`, the frames go into one uncompressed YUV4MPEG2
+// video, which most video tools can read. Otherwise each frame is saved
+// as its own PNG file, named by appending the frame number and `.png` to
+// the path, so `clips/match-` gives `clips/match-000001.png` and so on.
+//
+// Capturing copies the frame into one of a fixed number of buffers, all
+// allocated up front, and background threads do the encoding and writing.
+// If encoding falls behind and every buffer is still waiting, the frame is
+// dropped rather than making the game wait. A video skips dropped frames;
+// PNG files are numbered by the engine's frame, so drops leave gaps.
+class Recorder
+{
+public:
+    // Has recording been requested through the environment?
+    static bool requested() noexcept;
+
+    // Reads the settings from the environment and opens the output, for
+    // frames of the given dimensions shown at the given rate. Throws
+    // exceptions::Client_logic_error if the settings are malformed or the
+    // video cannot be created.
+    Recorder(Dimensions, double frame_rate);
+
+    // Finishes encoding the frames already captured.
+    ~Recorder();
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    // Copies the frame the renderer has just drawn, unless no buffer is
+    // free. Call it before presenting, after which the frame may be gone.
+    // Never waits for encoding.
+    void capture(const Renderer&) noexcept;
+
+    // Counts frames captured and dropped so far.
+    unsigned long captured() const;
+    unsigned long dropped() const;
+
+private:
+    struct Frame_
+    {
+        unsigned long number = 0;
+        Rgba_image image;
+    };
+
+    void work_();
+    void encode_png_(const Frame_&);
+    void encode_y4m_(const Frame_&, std::vector<uint8_t>& planes);
+
+    std::string path_;
+    bool video_;
+    Dimensions dimensions_;
+    std::ofstream video_out_;
+
+    std::vector<std::unique_ptr<Frame_>> frames_;
+
+    // Guards everything below. The engine holds it only to take a free
+    // buffer and hand it back filled, never while copying or encoding.
+    mutable std::mutex mutex_;
+    std::condition_variable frame_ready_;
+    // Both have room for every buffer, so they never allocate.
+    std::vector<Frame_*> free_;
+    std::vector<Frame_*> ready_;
+    bool stopping_ = false;
+
+    unsigned long frame_number_ = 0;
+    unsigned long captured_ = 0;
+    unsigned long dropped_ = 0;
+
+    std::vector<std::thread> workers_;
+};
+
+} // end namespace detail
+
+}
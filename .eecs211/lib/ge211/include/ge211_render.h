@@ -5,17 +5,47 @@
 #include "ge211_geometry.h"
 #include "ge211_window.h"
 #include "ge211_util.h"
+
+#include <SDL_blendmode.h>
 #include <memory>
 
 namespace ge211 {
 
 namespace detail {
 
+// One of the two halves of a custom blend mode, as passed to
+// SDL_ComposeCustomBlendMode: the factors the source and destination are
+// multiplied by, and how the products are combined.
+struct Blend_equation
+{
+    SDL_BlendFactor source;
+    SDL_BlendFactor destination;
+    SDL_BlendOperation operation;
+};
+
+// How target textures are copied, for both their colors and their alpha.
+// Sprites blended into a transparent texture leave its colors
+// premultiplied by alpha, so the source is added as it is to whatever
+// its alpha leaves of the destination.
+extern const Blend_equation premultiplied_blend;
+
+// The color modulation that tints a premultiplied texture the way the
+// given color tints an ordinary one: the tint's alpha scales its colors.
+Color premultiplied_tint(Color) noexcept;
+
 class Renderer
 {
 public:
     explicit Renderer(const Window&);
 
+    // An offscreen renderer, which draws in software into an RGBA32
+    // framebuffer in memory. It needs no display.
+    explicit Renderer(Dimensions);
+
+    // The pixels an offscreen renderer draws into, or nullptr for a
+    // window's renderer. They are up to date after present().
+    const SDL_Surface* get_framebuffer() const noexcept;
+
     bool is_vsync() const noexcept;
 
     void set_color(Color);
@@ -28,16 +58,78 @@ public:
     // actually copying it.
     void prepare(const Texture&) const;
 
+    // Creates a texture whose ARGB8888 pixels are meant to be rewritten
+    // by the CPU, via Texture::lock and Texture::unlock, every frame. Its
+    // initial contents are undefined.
+    Texture create_streaming_texture(Dimensions) const;
+
+    // Can this renderer draw into textures, and then copy them with their
+    // colors premultiplied by alpha? The software renderer can't do the
+    // latter.
+    bool supports_targets() const noexcept;
+
+    // Creates a transparent texture that can be drawn into with a
+    // Target_scope. Sprites blended into it leave its colors premultiplied
+    // by alpha, so it is copied without multiplying them again.
+    //
+    // \preconditions
+    //  - supports_targets()
+    Texture create_target_texture(Dimensions) const;
+
+    // While it exists, redirects drawing into a texture that came from
+    // create_target_texture. Afterward, drawing goes back to wherever it
+    // went before, in the color it had before. The renderer doesn't keep
+    // the texture past then.
+    class Target_scope
+    {
+    public:
+        Target_scope(Renderer&, const Texture&);
+        ~Target_scope();
+
+        Target_scope(const Target_scope&) = delete;
+        Target_scope& operator=(const Target_scope&) = delete;
+
+    private:
+        Renderer& renderer_;
+        SDL_Texture* previous_target_;
+        Color previous_color_;
+    };
+
+    // Target textures may lose their contents, e.g. when the window is
+    // resized or the graphics device is reset. This counter goes up
+    // every time that may have happened, so anything cached in a target
+    // texture should be redrawn when it changes.
+    unsigned long target_generation() const noexcept;
+
+    // Records that target textures may have lost their contents.
+    void invalidate_targets() noexcept;
+
     void present() noexcept;
 
+    // The size of what the renderer draws into, in pixels, which may be
+    // larger than the window's dimensions on a high-density display.
+    Dimensions output_dimensions() const noexcept;
+
+    // Copies the frame drawn so far into `image`, resizing it to
+    // output_dimensions(). Call before present(), after which the frame
+    // may be gone. Returns false if the pixels cannot be read.
+    bool read_pixels(Rgba_image& image) const noexcept;
+
 private:
     friend Texture;
 
     SDL_Renderer* get_raw_() const noexcept;
 
     static SDL_Renderer* create_renderer_(SDL_Window*);
+    static SDL_Surface* create_framebuffer_(Dimensions);
+    static SDL_Renderer* create_offscreen_renderer_(SDL_Surface*);
+    static bool check_targets_(SDL_Renderer*) noexcept;
 
+    // Only for offscreen renderers. It must outlive ptr_.
+    delete_ptr<SDL_Surface> framebuffer_;
     delete_ptr<SDL_Renderer> ptr_;
+    bool supports_targets_;
+    unsigned long target_generation_ = 0;
 };
 
 // A texture is initially created as a (device-independent) `SDL_Surface`,
@@ -56,14 +148,45 @@ public:
     explicit Texture(SDL_Surface*);
     explicit Texture(delete_ptr<SDL_Surface>);
 
+    // A texture that refers to the given region of another texture (an
+    // *atlas*). Both share the same `SDL_Surface` and, once rendered, the
+    // same `SDL_Texture`, so consecutive copies of regions of one atlas
+    // don't switch textures.
+    //
+    // \preconditions
+    //  - `atlas` is not empty and `region` lies within its dimensions.
+    Texture(Texture const& atlas, Rectangle region) noexcept;
+
+    // These come from the copy kept when the texture was created or
+    // converted from its surface, so they never ask SDL.
     Dimensions dimensions() const noexcept;
 
+    // The texture's SDL pixel format.
+    uint32_t format() const noexcept;
+
+    // Can the texture be locked for streaming, as by lock()?
+    bool is_streaming() const noexcept;
+
     // Returns nullptr if this `Texture` has been rendered, and can no
-    // longer be updated as an `SDL_Surface`.
+    // longer be updated as an `SDL_Surface`. Also returns nullptr for
+    // regions of an atlas, which must not be drawn on individually.
     SDL_Surface* as_surface() noexcept;
 
     bool empty() const noexcept;
 
+    // Is this texture a region of a larger atlas texture?
+    bool is_region() const noexcept;
+
+    // For streaming textures only: locks the given region for writing,
+    // returning its first row of pixels and setting `pitch` to the
+    // distance between rows in bytes. The previous contents of the region
+    // are undefined, so every pixel should be written. Returns nullptr if
+    // the texture cannot be locked.
+    uint32_t* lock(Rectangle region, int& pitch) noexcept;
+
+    // Uploads the changes to a locked texture.
+    void unlock() noexcept;
+
 private:
     friend Renderer;
 
@@ -77,6 +200,17 @@ private:
 
         delete_ptr<SDL_Surface> surface_;
         delete_ptr<SDL_Texture> texture_;
+        // Whichever of surface_ and texture_ is non-null, described once
+        // when this is constructed.
+        Dimensions dimensions_{0, 0};
+        uint32_t format_ = 0;
+        bool streaming_ = false;
+        // Whether texture_'s colors are premultiplied by its alpha, as for
+        // a target texture.
+        bool premultiplied_ = false;
+        // The color and alpha modulation last set on texture_, so that
+        // drawing many copies with the same tint sets it only once.
+        Color modulation_ = Color::white();
         // Invariant:
         //  - Exactly one surface_ and texture_ is non-null.
         //  - Whichever is non-null is non-zero-sized.
@@ -85,7 +219,19 @@ private:
 
     SDL_Texture* get_raw_(const Renderer&) const;
 
+    // Sets the color and alpha modulation of the raw texture, unless it
+    // is already set. Regions of an atlas share it. For a premultiplied
+    // texture, the alpha scales the color modulation, too.
+    void modulate_(SDL_Texture*, Color) const noexcept;
+
+    // Returns the source rectangle to copy from, or nullptr to copy the
+    // whole texture.
+    SDL_Rect const* get_region_(SDL_Rect& buffer) const noexcept;
+
     std::shared_ptr<Impl_> impl_;
+    // Only meaningful when is_region_ is true.
+    Rectangle region_{0, 0, 0, 0};
+    bool is_region_ = false;
 };
 
 } // end namespace detail
@@ -4,6 +4,9 @@
 #include "ge211_util.h"
 #include "ge211_error.h"
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
 #include <vector>
 
@@ -13,16 +16,117 @@ namespace detail {
 
 std::vector<const char*> get_search_prefixes();
 
+// SDL_ttf shares state between fonts and is not thread-safe, so every
+// call into it holds this lock. This lets fonts be loaded on background
+// threads (see Loader) while text is rendered on the main thread.
+std::mutex& ttf_mutex();
+
+// The whole contents of a resource file.
+using Resource_bytes = std::vector<unsigned char>;
+
+// Reads a whole resource file into memory. While the result is alive,
+// loading the same file again returns the same bytes.
+std::shared_ptr<const Resource_bytes>
+load_resource_bytes(const std::string& filename);
+
+// A cache of decoded assets, such as fonts and images, keyed by their
+// filename and whatever parameters they were decoded with. It hands out
+// shared pointers and keeps only weak ones itself, so an asset is loaded
+// once no matter how many objects use it, and freed when the last of them
+// is destroyed.
+//
+// The loader runs without the lock held, so two threads missing on the
+// same key at once may both load it; the first to finish wins and the
+// other's copy is thrown away.
+template <class KEY, class T>
+class Asset_cache
+{
+public:
+    // Returns the cached asset for `key`, or calls `load()` to produce
+    // a `std::shared_ptr<T>` and caches that.
+    template <class LOADER>
+    std::shared_ptr<T> get(const KEY& key, LOADER load)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto iter = entries_.find(key);
+            if (iter != entries_.end()) {
+                if (auto found = iter->second.lock()) {
+                    ++hits_;
+                    return found;
+                }
+            }
+        }
+
+        std::shared_ptr<T> loaded = load();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++misses_;
+        auto iter = entries_.find(key);
+        if (iter != entries_.end()) {
+            if (auto found = iter->second.lock()) return found;
+        }
+
+        // Misses mean loading, which costs far more than this, so they
+        // are when the entries of freed assets are cleared out.
+        sweep_();
+        entries_[key] = loaded;
+        return loaded;
+    }
+
+    // How many calls to get found the asset already loaded.
+    unsigned long hits() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hits_;
+    }
+
+    // How many calls to get had to load the asset.
+    unsigned long misses() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return misses_;
+    }
+
+private:
+    // Erases the entries of assets that have been freed. Requires mutex_.
+    void sweep_()
+    {
+        for (auto iter = entries_.begin(); iter != entries_.end(); ) {
+            if (iter->second.expired())
+                iter = entries_.erase(iter);
+            else
+                ++iter;
+        }
+    }
+
+    mutable std::mutex mutex_;
+    std::map<KEY, std::weak_ptr<T>> entries_;
+    unsigned long hits_ = 0;
+    unsigned long misses_ = 0;
+};
+
 class File_resource
 {
 public:
     explicit File_resource(const std::string&);
 
+    // Reads from the given file's bytes, already in memory, which must
+    // outlive the resource.
+    File_resource(const Resource_bytes&, const std::string& filename);
+
+    // Returns the path at which the given resource file can be opened,
+    // found by trying each search prefix in order. The answer is
+    // remembered, so the search prefixes are walked at most once per
+    // filename. Throws exceptions::File_error if the file cannot be found.
+    static std::string resolve_path(const std::string& filename);
+
     SDL_RWops* get_raw() const noexcept { return ptr_.get(); }
     SDL_RWops* release() && { return ptr_.release(); }
 
 private:
     static delete_ptr<SDL_RWops> open_rwops_(const std::string&);
+    static std::string search_path_(const std::string&);
 
     delete_ptr<SDL_RWops> ptr_;
 };
@@ -35,6 +139,11 @@ private:
 /// project. You can create multiple Font instances for the same font
 /// file at different sizes.
 ///
+/// Fonts are cached: constructing a Font with the same filename and size
+/// as one that still exists shares the already loaded font rather than
+/// loading it again, and fonts of different sizes share the file's
+/// contents.
+///
 /// One TTF file, `sans.tff`, is included among %ge211's built-in resources,
 /// and can always be used even if you haven't added any fonts yourself.
 ///
@@ -57,12 +166,10 @@ private:
 
     TTF_Font* get_raw_() const noexcept { return ptr_.get(); }
 
-    static detail::delete_ptr<TTF_Font>
-    load_(const std::string& filename,
-          detail::File_resource&& ttf_file,
-          int size);
+    static std::shared_ptr<TTF_Font>
+    load_(const std::string& filename, int size);
 
-    detail::delete_ptr<TTF_Font> ptr_;
+    std::shared_ptr<TTF_Font> ptr_;
 };
 
 }
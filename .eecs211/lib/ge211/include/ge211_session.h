@@ -4,18 +4,32 @@ namespace ge211 {
 
 namespace detail {
 
+// Initializes SDL and its libraries while any Session exists. A windowed
+// session also initializes video and text input; a headless one, for
+// rendering offscreen, needs no display.
 class Session
 {
 public:
-    Session();
+    enum class Mode
+    {
+        windowed,
+        headless,
+    };
+
+    explicit Session(Mode = Mode::windowed);
 
     ~Session();
 
-    Session(Session&&) = default;
-    Session& operator=(Session&&) = default;
+    Session(Session&&) noexcept;
+    Session& operator=(Session&&) = delete;
 
     Session(const Session&) = delete;
     Session& operator=(const Session&) = delete;
+
+private:
+    // Moved-from sessions are inactive and clean up nothing.
+    bool active_ = true;
+    Mode mode_;
 };
 
 } // end namespace detail
@@ -7,6 +7,8 @@
 #include "ge211_render.h"
 #include "ge211_resource.h"
 
+#include <functional>
+#include <memory>
 #include <vector>
 #include <sstream>
 
@@ -48,6 +50,7 @@ private:
     friend detail::Engine;
     friend detail::Placed_sprite;
     friend Multiplexed_sprite;
+    friend Offscreen_renderer;
 
     virtual void render(detail::Renderer&,
                         Position,
@@ -107,7 +110,16 @@ protected:
     /// This should only be called from the derived class's constructor.
     void set_pixel(Position, Color);
 
+    /// Sets the pixels of row `y` from `x_begin` up to (but not including)
+    /// `x_end` to the given color, writing them straight into the surface,
+    /// which is much faster than fill_rectangle for a single row. The
+    /// pixels must lie within the sprite.
+    /// This should only be called from the derived class's constructor.
+    void fill_row(int y, int x_begin, int x_end, Color);
+
 private:
+    friend Sprite_atlas;
+
     Texture texture_;
     Texture const& get_texture_() const override;
 
@@ -133,7 +145,9 @@ public:
     ///  - both dimensions must be positive
     explicit Rectangle_sprite(Dimensions, Color = Color::white());
 
-    /// Changes the color of this rectangle sprite.
+    /// Changes the color of this rectangle sprite, which redraws it. To
+    /// draw one sprite in several colors, make it white and tint it with
+    /// Transform::tint(Color) instead.
     void recolor(Color);
 };
 
@@ -141,20 +155,37 @@ public:
 class Circle_sprite : public detail::Render_sprite
 {
 public:
+    /// How the edge of a circle is drawn.
+    enum class Edge
+    {
+        /// Every pixel is either wholly inside the circle or outside it.
+        sharp,
+        /// Pixels along the edge are partly transparent, according to how
+        /// much of each one the circle covers. This looks smoother,
+        /// especially for small circles and scaled ones.
+        smooth,
+    };
+
     /// Constructs a circle sprite from its radius and optionally
-    /// a Color, which defaults to white. Note that when positioned,
+    /// a Color, which defaults to white, and an Edge, which defaults to
+    /// Edge::sharp. Note that when positioned,
     /// the reference point is the upper-left corner of the bounding
     /// box of the sprite, not the center of the circle.
     ///
     /// \preconditions
     ///  - radius must be positive
-    explicit Circle_sprite(int radius, Color = Color::white());
+    explicit Circle_sprite(int radius, Color = Color::white(),
+                           Edge = Edge::sharp);
 
-    /// Changes the color of this circle sprite.
+    /// Changes the color of this circle sprite, which redraws it. To
+    /// draw one sprite in several colors, make it white and tint it with
+    /// Transform::tint(Color) instead.
     void recolor(Color);
 
 private:
     int radius_() const;
+
+    Edge edge_;
 };
 
 /// A Sprite that displays a bitmap image.
@@ -165,14 +196,19 @@ public:
     /// image to display. The image must be saved in the project's
     /// `Resources/` directory. Many image formats are supported,
     /// including JPEG, PNG, GIF, BMP, etc.
+    ///
+    /// Images are cached: image sprites of the same file share one
+    /// decoded image, which is loaded only once as long as any of them
+    /// exists.
     explicit Image_sprite(std::string const& filename);
 
 private:
     detail::Texture const& get_texture_() const override;
 
-    static detail::Texture load_texture_(std::string const& filename);
+    static std::shared_ptr<const detail::Texture>
+    load_texture_(std::string const& filename);
 
-    detail::Texture texture_;
+    std::shared_ptr<const detail::Texture> texture_;
 };
 
 /// A Sprite that displays text.
@@ -343,6 +379,214 @@ private:
     Timer since_;
 };
 
+/// Packs the images of several shape sprites into one shared texture.
+///
+/// Ordinarily every Rectangle_sprite and Circle_sprite owns its own
+/// texture, so drawing a scene full of different shapes makes the
+/// renderer switch textures on nearly every copy. Once packed into an
+/// atlas, the sprites render as regions of the atlas's texture instead,
+/// which lets the renderer batch consecutive copies together. Packed
+/// sprites behave just like before; the atlas itself need not outlive
+/// them.
+///
+/// For example:
+///
+/// ```cpp
+/// Circle_sprite red_ball{5, Color::medium_red()};
+/// Circle_sprite blue_ball{5, Color::medium_blue()};
+/// Sprite_atlas atlas;
+///
+/// atlas.pack(red_ball);
+/// atlas.pack(blue_ball);
+/// ```
+///
+/// All packing must happen before any of the packed sprites is rendered
+/// or prepared, because at that point the atlas is converted to a texture
+/// that can no longer be drawn on.
+class Sprite_atlas
+{
+public:
+    /// Constructs an empty atlas of the given size. The default size is
+    /// supported by every renderer we know of.
+    ///
+    /// \preconditions
+    ///  - both dimensions must be positive
+    explicit Sprite_atlas(Dimensions = {1024, 1024});
+
+    /// Copies the sprite's image into this atlas and makes the sprite
+    /// render from the atlas from now on. Recoloring the sprite afterward
+    /// gives it its own texture again.
+    ///
+    /// Throws exceptions::Client_logic_error if the sprite does not fit in
+    /// the remaining space, if the sprite has already been rendered, or if
+    /// this atlas has already been rendered.
+    void pack(detail::Render_sprite&);
+
+    /// Returns the dimensions of the atlas.
+    Dimensions dimensions() const;
+
+private:
+    // Finds room for a sprite of the given dimensions, or throws.
+    Rectangle allocate_(Dimensions);
+
+    detail::Texture texture_;
+
+    // Packing is by shelves: sprites are placed left to right along the
+    // current shelf, and a new shelf starts below the tallest sprite on
+    // the current one when the row fills.
+    Position cursor_{0, 0};
+    int shelf_height_ = 0;
+};
+
+/// A Sprite that draws a whole batch of small solid circles at once.
+///
+/// Rendering thousands of circle sprites costs one copy per circle, and
+/// past some point the copies themselves dominate the frame. A circle
+/// batch instead rasterizes its circles into one streaming texture on the
+/// CPU and uploads it with a single copy, so its cost depends on the
+/// number of pixels covered rather than on the number of circles. Each
+/// circle covers exactly the pixels a Circle_sprite of the same radius
+/// would.
+///
+/// The batch covers a canvas of fixed dimensions; circles are positioned
+/// within the canvas, and the canvas itself is positioned like any other
+/// sprite. Circles that fall partly outside the canvas are clipped.
+///
+/// For example, to draw every ball in a model each frame:
+///
+/// ```cpp
+/// balls_.clear();
+/// for (Ball const& ball : model_.balls())
+///     balls_.add_circle(ball.top_left(), ball_radius, ball_color);
+/// sprites.add_sprite(balls_, {0, 0});
+/// ```
+class Circle_batch_sprite : public Sprite
+{
+public:
+    /// Constructs an empty batch with a canvas of the given dimensions.
+    ///
+    /// \preconditions
+    ///  - both dimensions must be positive
+    explicit Circle_batch_sprite(Dimensions);
+
+    /// Removes all circles from the batch.
+    void clear() noexcept;
+
+    /// Makes room for the given number of circles, so that adding that
+    /// many does not allocate.
+    void reserve(size_t);
+
+    /// Adds a circle to the batch. As with Circle_sprite, the position is
+    /// the upper-left corner of the circle's bounding box. Circles added
+    /// later are drawn on top of those added earlier.
+    ///
+    /// \preconditions
+    ///  - radius must be positive
+    void add_circle(Position, int radius, Color);
+
+    /// The number of circles in the batch.
+    size_t size() const noexcept;
+
+    Dimensions dimensions() const override;
+
+private:
+    struct Circle_
+    {
+        Position top_left;
+        int radius;
+        uint32_t pixel;
+    };
+
+    void render(detail::Renderer&, Position, Transform const&) const override;
+
+    // Writes the circles into locked pixels that cover `locked`.
+    void rasterize_(uint32_t* pixels, int pitch, Rectangle locked) const;
+
+    // Makes sure spans_by_radius_[radius] holds the half-width of each
+    // row of a circle with that radius, top to bottom.
+    void compute_spans_(int radius);
+
+    Dimensions dimensions_;
+    std::vector<Circle_> circles_;
+    std::vector<std::vector<int>> spans_by_radius_;
+
+    // The part of the canvas that the current circles cover, and the
+    // part that was drawn on last render. Only their union needs to be
+    // locked and rewritten.
+    Rectangle bounds_{0, 0, 0, 0};
+    mutable Rectangle painted_{0, 0, 0, 0};
+
+    mutable detail::Texture texture_;
+};
+
+/// A Sprite composed of other sprites, which are drawn together into a
+/// texture of its own once and then rendered as one image.
+///
+/// This is meant for static parts of a scene, such as a background with
+/// borders and labels, that would otherwise be re-submitted sprite by
+/// sprite every frame. The sprites are added like they are added to a
+/// Sprite_set, with positions relative to the layer's upper-left corner
+/// and z values that order them within the layer. The composed image is
+/// kept until the layer changes, until invalidate() is called, or until
+/// the renderer loses it (for example when the window is resized).
+///
+/// For example:
+///
+/// ```cpp
+/// Layer_sprite background{{800, 400}};
+/// background.add_sprite(border_, {0, 0})
+///           .add_sprite(label_, {10, 10});
+/// // then, every frame:
+/// sprites.add_sprite(background, {0, 0}, -1);
+/// ```
+///
+/// The layer refers to its sprites rather than copying them, so they
+/// must outlive it. If a sprite changes, call invalidate() to have the
+/// layer redrawn. On renderers that cannot draw into textures, or cannot
+/// blend them with premultiplied alpha (such as the software renderer that
+/// Offscreen_renderer uses), the layer falls back to rendering its sprites
+/// one by one each frame, in which case a Transform applied to the layer
+/// as a whole is ignored.
+class Layer_sprite : public Sprite
+{
+public:
+    /// Constructs an empty layer of the given dimensions.
+    ///
+    /// \preconditions
+    ///  - both dimensions must be positive
+    explicit Layer_sprite(Dimensions);
+
+    /// Adds a sprite to the layer, positioned relative to the layer.
+    Layer_sprite& add_sprite(const Sprite&, Position, int z = 0);
+
+    /// Adds a sprite to the layer with a transformation.
+    Layer_sprite& add_sprite(const Sprite&, Position, int z,
+                             const Transform&);
+
+    /// Removes all the sprites from the layer.
+    void clear();
+
+    /// Makes the layer compose its sprites again the next time it is
+    /// rendered.
+    void invalidate() noexcept;
+
+    Dimensions dimensions() const override;
+
+private:
+    void render(detail::Renderer&, Position, Transform const&) const override;
+
+    // Composes the sprites into texture_.
+    void bake_(detail::Renderer&) const;
+
+    Dimensions dimensions_;
+    mutable std::vector<detail::Placed_sprite> contents_;
+    mutable std::vector<detail::Placed_sprite> sort_buffer_;
+
+    mutable detail::Texture texture_;
+    mutable bool dirty_ = true;
+    mutable unsigned long baked_generation_ = 0;
+};
+
 } // end namespace sprites
 
 namespace detail {
@@ -361,27 +605,161 @@ struct Placed_sprite
 
 bool operator<(Placed_sprite const&, Placed_sprite const&) noexcept;
 
+// Sorts placed sprites into ascending z order, keeping sprites with equal
+// z in the order they were added. When the z values span a small range,
+// as they do in most games, this is a counting sort in linear time. Uses
+// `buffer` as scratch space so that its capacity can be reused.
+void sort_by_z(std::vector<Placed_sprite>& sprites,
+               std::vector<Placed_sprite>& buffer);
+
+// A placement that a Sprite_set keeps from frame to frame. It is shared
+// between the Sprite_set, which renders it, and any Sprite_handle%s,
+// which update it.
+struct Retained_sprite
+{
+    Placed_sprite placed;
+    bool visible = true;
+    bool z_changed = false;
+    bool removed = false;
+
+    explicit Retained_sprite(Placed_sprite const&) noexcept;
+};
+
 } // end namespace detail
 
+/// A handle to a sprite retained by a Sprite_set from frame to frame.
+///
+/// Sprites added with Sprite_set::add_sprite(Sprite const&, Position, int)
+/// last for one frame only, so a scene has to be rebuilt in every call to
+/// Abstract_game::draw(Sprite_set&). Sprites added with
+/// Sprite_set::add_retained(Sprite const&, Position, int, Transform const&)
+/// instead stay in the scene, already sorted by *z*, until they are
+/// removed. Their placement can be changed through the Sprite_handle
+/// returned when adding them, which makes them a good fit for parts of
+/// the scene that rarely change, such as walls and labels.
+///
+/// A retained sprite stays in the scene until remove() is called on a
+/// handle to it or until every handle to it has been destroyed. Handles
+/// can be copied, and copies refer to the same retained sprite.
+class Sprite_handle
+{
+public:
+    /// Constructs the empty handle, which does not refer to any sprite.
+    Sprite_handle() noexcept;
+
+    /// Is this the empty handle, or a handle to a removed sprite?
+    bool empty() const noexcept;
+
+    /// Recognizes a non-empty handle. Equivalent to `!empty()`.
+    operator bool() const noexcept;
+
+    /// \name Setters
+    /// These all require a non-empty handle; throw
+    /// exceptions::Client_logic_error if violated.
+    /// @{
+
+    /// Replaces the sprite to render. As with
+    /// Sprite_set::add_sprite(Sprite const&, Position, int), the
+    /// sprite is not copied and must continue to live while retained.
+    Sprite_handle& set_sprite(Sprite const&);
+    /// Moves the sprite.
+    Sprite_handle& set_position(Position);
+    /// Changes the sprite's stacking order.
+    Sprite_handle& set_z(int);
+    /// Changes the transform to render the sprite with.
+    Sprite_handle& set_transform(Transform const&);
+    /// Shows or hides the sprite without removing it from the scene.
+    Sprite_handle& set_visible(bool);
+
+    /// @}
+
+    /// \name Getters
+    /// These all require a non-empty handle; throw
+    /// exceptions::Client_logic_error if violated.
+    /// @{
+
+    /// The sprite currently rendered.
+    Sprite const& get_sprite() const;
+    /// The position of the sprite.
+    Position get_position() const;
+    /// The stacking order of the sprite.
+    int get_z() const;
+    /// The transform the sprite is rendered with.
+    Transform const& get_transform() const;
+    /// Whether the sprite is currently shown.
+    bool get_visible() const;
+
+    /// @}
+
+    /// Removes the sprite from the scene. Afterward this handle, and any
+    /// copies of it, are empty.
+    void remove() noexcept;
+
+private:
+    friend Sprite_set;
+
+    explicit Sprite_handle(std::shared_ptr<detail::Retained_sprite>) noexcept;
+
+    detail::Retained_sprite& get_() const;
+
+    std::shared_ptr<detail::Retained_sprite> ptr_;
+};
+
+/// A list of positioned sprites to add to a Sprite_set, which can be built
+/// on another thread. Building the scene for thousands of entities takes
+/// time of its own, so a game can split its entities among threads, have
+/// each thread add its share to its own Sprite_list, and then add the
+/// lists to the Sprite_set one after another. Sprite_set::add_parallel()
+/// does all that.
+///
+/// A Sprite_list only holds sprites added for one frame, not retained
+/// ones. Building one doesn't touch the sprites, so different threads can
+/// add the same Sprite to their lists at once.
+class Sprite_list
+{
+public:
+    /// Adds the given sprite, as Sprite_set::add_sprite(Sprite const&,
+    /// Position, int) does.
+    Sprite_list& add_sprite(Sprite const&, Position, int z = 0);
+
+    /// Adds the given sprite with a transform, as
+    /// Sprite_set::add_sprite(Sprite const&, Position, int, Transform const&)
+    /// does.
+    Sprite_list& add_sprite(Sprite const&, Position, int z, Transform const&);
+
+    /// Makes room for at least the given number of sprites in all, so
+    /// adding that many won't have to reallocate.
+    void reserve(size_t);
+
+    /// The number of sprites in the list.
+    size_t size() const noexcept;
+
+private:
+    friend Sprite_set;
+
+    std::vector<detail::Placed_sprite> sprites_;
+};
+
 /// A collection of positioned sprites ready to be rendered to the screen. Each
 /// time Abstract_game::draw(Sprite_set&) is called by the game engine, it is
-/// given an empty Sprite_set, and it must add every sprites::Sprite that
-/// should appear on the screen to that Sprite_set. Each Sprite is added
+/// given a Sprite_set containing only the retained sprites, and it must add
+/// every other sprites::Sprite that should appear on the screen to that
+/// Sprite_set. Each Sprite is added
 /// with an x–y geometry::Position and a z
 /// coordinate that determines stacking order. Each sprite may have a
 /// geometry::Transform applied as well.
 ///
 /// \sa add_sprite(Sprite const&, Position, int)
 /// \sa add_sprite(Sprite const&, Position, int, Transform const&)
+/// \sa add_retained(Sprite const&, Position, int, Transform const&)
 class Sprite_set
 {
 public:
     /// Adds the given sprite at the given x–y geometry::Position and optional z
     /// coordinate, which defaults to 0.
     /// Sprites with higher `z` values will be rendered on top of those with
-    /// lower `z` values. Two sprites with the same `z` value that interfere
-    /// will be stacked in an arbitrary order, so if you care about the layering
-    /// of your sprites, provide different `z` values.
+    /// lower `z` values. Two sprites with the same `z` value are stacked in
+    /// the order they were added, so the sprite added last ends up on top.
     ///
     /// Note that the Sprite_set does not copy the sprite it is given, but
     /// just stores a reference to it. Thus, the Sprite must live somewhere
@@ -394,11 +772,81 @@ public:
     /// rendered.
     Sprite_set& add_sprite(Sprite const&, Position, int z, Transform const&);
 
+    /// Adds the given sprite to be rendered on every frame from now on,
+    /// rather than only the next one. Returns a Sprite_handle for moving,
+    /// hiding, or removing it later; when the last handle is destroyed, the
+    /// sprite is removed, so be sure to store the result.
+    ///
+    /// Retained sprites are kept sorted by `z`, so unlike sprites added with
+    /// add_sprite(Sprite const&, Position, int), they cost nothing to add
+    /// or sort on frames where they don't change. At the same `z`, retained
+    /// sprites are rendered below those added for one frame.
+    ///
+    /// As with add_sprite(Sprite const&, Position, int), the Sprite must
+    /// continue to live for as long as it is retained.
+    Sprite_handle add_retained(Sprite const&, Position, int z = 0,
+                               Transform const& = Transform{});
+
+    /// Makes room for at least the given number of sprites added for
+    /// this frame, so adding that many won't have to reallocate. The room
+    /// stays from frame to frame, so a game whose scene keeps about the
+    /// same size only needs to do this once.
+    void reserve(size_t);
+
+    /// Adds every sprite in the given list, in order, as though each had
+    /// been added with add_sprite(Sprite const&, Position, int, Transform
+    /// const&). Leaves the list empty but keeps its room, so it can be
+    /// reused for the next frame.
+    Sprite_set& add_sprites(Sprite_list&);
+
+    /// A function that adds to a Sprite_list the sprites for entities
+    /// `begin` up to (but not including) `end`.
+    using Build_function =
+            std::function<void(Sprite_list&, size_t begin, size_t end)>;
+
+    /// Builds sprites for `count` entities on up to `thread_count` threads
+    /// and adds them. The entities are split into consecutive ranges, one
+    /// per thread, and the lists are added in the order of their ranges,
+    /// so the sprites end up in the same order as if `build` had been
+    /// called once for all `count` entities, however many threads there
+    /// are. The calling thread builds the first range itself.
+    ///
+    /// `build` is called on several threads at once, so it must only read
+    /// shared data, such as the model, and write to the list it is given.
+    /// If it throws, the sprites it built are discarded and the exception
+    /// is rethrown once every thread has finished.
+    ///
+    /// Starting threads takes tens of microseconds, so this only pays off
+    /// for many thousands of entities; for fewer, pass a `thread_count`
+    /// of 1, which builds on the calling thread.
+    ///
+    /// \preconditions
+    ///  - `thread_count` is positive, throws
+    ///    exceptions::Client_logic_error if violated.
+    Sprite_set& add_parallel(size_t count, unsigned thread_count,
+                             Build_function const& build);
+
 private:
     friend detail::Engine;
+    friend Offscreen_renderer;
 
     Sprite_set();
+
+    // Drops removed retained sprites, and re-sorts if any changed z.
+    void update_retained_();
+
+    // Renders the sprites in z order, and then drops those added for
+    // just this frame.
+    void paint_(detail::Renderer&);
+
     std::vector<detail::Placed_sprite> sprites_;
+    std::vector<detail::Placed_sprite> sort_buffer_;
+
+    // One per thread used by add_parallel(), kept to reuse their room.
+    std::vector<Sprite_list> lists_;
+
+    // Sorted by z, stably.
+    std::vector<std::shared_ptr<detail::Retained_sprite>> retained_;
 };
 
 }
@@ -138,6 +138,7 @@ public:
 private:
     friend Time_point;
     friend detail::Engine;
+    friend detail::Frame_pacer;
 
     Duration(std::chrono::duration<double> duration)
             : Duration{std::chrono::duration_cast<detail::Clock::duration>
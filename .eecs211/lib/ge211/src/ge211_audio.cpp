@@ -5,6 +5,8 @@
 #include <SDL_mixer.h>
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 
 namespace ge211 {
@@ -33,8 +35,10 @@ std::shared_ptr<Mix_Music> Music_track::load_(const std::string& filename)
 }
 
 Music_track::Music_track(const std::string& filename, const Mixer&)
-        : ptr_{load_(filename)}
-{ }
+{
+    static Asset_cache<std::string, Mix_Music> cache;
+    ptr_ = cache.get(filename, [&] { return load_(filename); });
+}
 
 bool Music_track::empty() const
 {
@@ -56,8 +60,32 @@ std::shared_ptr<Mix_Chunk> Sound_effect::load_(const std::string& filename)
 }
 
 Sound_effect::Sound_effect(const std::string& filename, const Mixer&)
-        : ptr_{load_(filename)}
-{ }
+{
+    static Asset_cache<std::string, Mix_Chunk> cache;
+    ptr_ = cache.get(filename, [&] { return load_(filename); });
+}
+
+Sound_effect::Sound_effect(const std::vector<uint8_t>& samples,
+                           const Mixer& mixer)
+{
+    const Audio_profile& profile = mixer.get_profile();
+    size_t sample_bytes =
+            profile.format == Audio_profile::Format::int16 ? 2 : 4;
+    size_t frame_bytes = sample_bytes * size_t(profile.channels);
+
+    if (samples.size() % frame_bytes != 0)
+        throw Client_logic_error(
+                "Sound_effect: samples are not a whole number of frames");
+
+    // Mix_QuickLoad_RAW doesn't copy the samples, so the deleter keeps
+    // them alive as long as the chunk.
+    auto owned = std::make_shared<std::vector<uint8_t>>(samples);
+    Mix_Chunk* raw = Mix_QuickLoad_RAW(owned->data(), Uint32(owned->size()));
+    if (!raw) throw Mixer_error::could_not_load_samples();
+
+    ptr_ = std::shared_ptr<Mix_Chunk>(
+            raw, [owned](Mix_Chunk* chunk) { Mix_FreeChunk(chunk); });
+}
 
 bool Sound_effect::empty() const
 {
@@ -69,21 +97,238 @@ Sound_effect::operator bool() const
     return !empty();
 }
 
-std::unique_ptr<Mixer> Mixer::open_mixer()
+Duration Audio_profile::buffer_latency() const
+{
+    return Duration(double(buffer_samples) / frequency);
+}
+
+Audio_profile Audio_profile::standard()
+{
+    return Audio_profile{};
+}
+
+Audio_profile Audio_profile::low_latency()
+{
+    Audio_profile profile;
+    profile.frequency = 48000;
+    profile.buffer_samples = 512;
+    profile.max_buffer_samples = 4096;
+    return profile;
+}
+
+static Uint16 to_sdl_format(Audio_profile::Format format)
+{
+    switch (format) {
+        case Audio_profile::Format::float32:
+            return AUDIO_F32SYS;
+        case Audio_profile::Format::int16:
+        default:
+            return AUDIO_S16SYS;
+    }
+}
+
+static bool is_power_of_two(int n)
+{
+    return n > 0 && (n & (n - 1)) == 0;
+}
+
+const int Mixer::default_effect_rate_limit = 2;
+
+// How often to check whether the audio thread has been running late,
+// and how many underruns in that time make the mixer fall back to larger
+// buffers.
+static const Duration underrun_check_period{1.0};
+static const unsigned long underruns_to_fall_back = 3;
+
+// The channels that SDL_mixer reports have finished playing, waiting for
+// the mixer to detach their effects.
+//
+// SDL_mixer calls the channel-finished callback with its audio lock
+// held, either from the audio thread when an effect ends or from the
+// game's thread when it halts a channel. The lock keeps the callers from
+// overlapping, so the queue only needs to support one producer and one
+// consumer, the game's thread. Neither side blocks or allocates.
+//
+// A channel is reported once each time it stops, and it can't start again
+// until the mixer has taken its report, so the queue can never hold more
+// than one entry per channel.
+class Channel_queue
+{
+public:
+    static const size_t capacity = 64;
+
+    void push(int channel) noexcept
+    {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_.load(std::memory_order_acquire) == capacity) return;
+
+        slots_[tail % capacity] = channel;
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+
+    bool pop(int& channel) noexcept
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) return false;
+
+        channel = slots_[head % capacity];
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    std::array<int, capacity> slots_{};
+    std::atomic<size_t> head_{0};
+    std::atomic<size_t> tail_{0};
+};
+
+static_assert(MIX_CHANNELS <= Channel_queue::capacity,
+              "Channel_queue is too small for MIX_CHANNELS");
+
+// SDL_mixer's callback takes no context, and there is only one Mixer.
+static Channel_queue finished_channels;
+
+static void on_channel_finished(int channel)
 {
-    if (Mix_OpenAudio(MIX_DEFAULT_FREQUENCY,
-                      MIX_DEFAULT_FORMAT,
-                      2,
-                      4096) >= 0)
-        return std::unique_ptr<Mixer>{new Mixer};
+    finished_channels.push(channel);
+}
+
+// Measures the audio thread from SDL_mixer's post-mix callback, which runs
+// once for each buffer the device plays. Only the audio thread writes and
+// only the game's thread reads, and it is reset only while the callback
+// isn't registered. A read may see the latest buffer's time without its
+// count, which is close enough for averaging over many buffers.
+class Audio_clock
+{
+public:
+    void reset(Duration period) noexcept
+    {
+        late_after_ = Uint64(1.5 * period.seconds() *
+                             SDL_GetPerformanceFrequency());
+        callbacks_.store(0, std::memory_order_relaxed);
+        underruns_.store(0, std::memory_order_relaxed);
+        first_.store(0, std::memory_order_relaxed);
+        last_.store(0, std::memory_order_relaxed);
+        longest_.store(0, std::memory_order_relaxed);
+    }
+
+    void tick() noexcept
+    {
+        Uint64 now = SDL_GetPerformanceCounter();
+        unsigned long count = callbacks_.load(std::memory_order_relaxed);
+
+        if (count == 0) {
+            first_.store(now, std::memory_order_relaxed);
+        } else {
+            Uint64 gap = now - last_.load(std::memory_order_relaxed);
+
+            if (gap > longest_.load(std::memory_order_relaxed))
+                longest_.store(gap, std::memory_order_relaxed);
+
+            // The device takes a moment to get going, so the first gap
+            // doesn't count.
+            if (count > 1 && gap > late_after_) {
+                underruns_.store(underruns_.load(std::memory_order_relaxed) + 1,
+                                 std::memory_order_relaxed);
+            }
+        }
+
+        last_.store(now, std::memory_order_relaxed);
+        callbacks_.store(count + 1, std::memory_order_release);
+    }
+
+    Audio_stats read() const noexcept
+    {
+        Audio_stats stats;
+        stats.callbacks = callbacks_.load(std::memory_order_acquire);
+        stats.underruns = underruns_.load(std::memory_order_relaxed);
+
+        double ticks = double(SDL_GetPerformanceFrequency());
+        Uint64 first = first_.load(std::memory_order_relaxed);
+        Uint64 last = last_.load(std::memory_order_relaxed);
+
+        if (stats.callbacks > 1) {
+            stats.average_period =
+                    Duration((last - first) / ticks / (stats.callbacks - 1));
+        }
+
+        stats.longest_period =
+                Duration(longest_.load(std::memory_order_relaxed) / ticks);
+
+        return stats;
+    }
+
+private:
+    Uint64 late_after_ = 0;
+    std::atomic<unsigned long> callbacks_{0};
+    std::atomic<unsigned long> underruns_{0};
+    std::atomic<Uint64> first_{0};
+    std::atomic<Uint64> last_{0};
+    std::atomic<Uint64> longest_{0};
+};
+
+static Audio_clock audio_clock;
+
+static void on_post_mix(void*, Uint8*, int)
+{
+    audio_clock.tick();
+}
+
+std::unique_ptr<Mixer> Mixer::open_mixer(const Audio_profile& requested)
+{
+    if (requested.frequency <= 0 ||
+        requested.channels <= 0 ||
+        !is_power_of_two(requested.buffer_samples)) {
+        throw Client_logic_error{"Mixer: invalid Audio_profile"};
+    }
+
+    Audio_profile profile = requested;
+    if (open_device_(profile))
+        return std::unique_ptr<Mixer>{new Mixer(profile)};
     else
         return {};
 }
 
-Mixer::Mixer()
-        : channels_(MIX_CHANNELS)
+// SDL_mixer lets the device pick its own sample rate and channel count,
+// and then converts each Sound_effect to match when loading it, so
+// playing doesn't convert anything.
+bool Mixer::open_device_(Audio_profile& profile) noexcept
+{
+    if (Mix_OpenAudio(profile.frequency,
+                      to_sdl_format(profile.format),
+                      profile.channels,
+                      profile.buffer_samples) < 0)
+        return false;
+
+    int frequency, channels;
+    Uint16 format;
+    if (Mix_QuerySpec(&frequency, &format, &channels)) {
+        profile.frequency = frequency;
+        profile.channels = channels;
+        profile.format = SDL_AUDIO_ISFLOAT(format)
+                         ? Audio_profile::Format::float32
+                         : Audio_profile::Format::int16;
+    }
+
+    return true;
+}
+
+Mixer::Mixer(const Audio_profile& profile)
+        : profile_(profile)
+        , channels_(MIX_CHANNELS)
+        , voices_(MIX_CHANNELS)
+        , spare_handles_(MIX_CHANNELS)
         , available_effect_channels_(MIX_CHANNELS)
 {
+    // Drops reports left over from any previous mixer.
+    int channel;
+    while (finished_channels.pop(channel)) { }
+    Mix_ChannelFinished(&on_channel_finished);
+    start_audio_clock_();
+
+    info_sdl() << "Audio device is " << profile_.frequency << " Hz with "
+               << profile_.buffer_samples << "-sample buffers";
+
     int music_decoders = Mix_GetNumMusicDecoders();
     info_sdl() << "Number of music decoders is " << music_decoders;
     for (int i = 0; i < music_decoders; ++i) {
@@ -99,9 +344,79 @@ Mixer::Mixer()
 
 Mixer::~Mixer()
 {
+    Mix_SetPostMix(nullptr, nullptr);
+    Mix_ChannelFinished(nullptr);
     Mix_CloseAudio();
 }
 
+Audio_stats Mixer::get_audio_stats() const noexcept
+{
+    return audio_clock.read();
+}
+
+void Mixer::start_audio_clock_() noexcept
+{
+    audio_clock.reset(profile_.buffer_latency());
+    Mix_SetPostMix(&on_post_mix, nullptr);
+
+    underruns_at_check_ = 0;
+    underrun_check_.reset();
+}
+
+void Mixer::check_underruns_()
+{
+    if (underrun_check_.elapsed_time() < underrun_check_period) return;
+
+    check_underruns_(audio_clock.read().underruns);
+}
+
+void Mixer::check_underruns_(unsigned long underruns)
+{
+    if (profile_.buffer_samples >= profile_.max_buffer_samples) return;
+
+    unsigned long recent = underruns - underruns_at_check_;
+    underruns_at_check_ = underruns;
+    underrun_check_.reset();
+
+    if (recent < underruns_to_fall_back) return;
+
+    // Keeps the device's rate, format and channels, which the loaded
+    // effects have already been converted to.
+    Audio_profile larger = profile_;
+    larger.buffer_samples = std::min(2 * profile_.buffer_samples,
+                                     profile_.max_buffer_samples);
+
+    warn_sdl() << "Audio underruns with " << profile_.buffer_samples
+               << "-sample buffers; falling back to "
+               << larger.buffer_samples;
+
+    // Closing the device stops everything, so stop it ourselves first to
+    // keep the channels and the music in step.
+    bool music_was_playing = music_state_ == State::playing;
+    if (music_state_ == State::playing || music_state_ == State::fading_out) {
+        Mix_HaltMusic();
+        music_position_.pause();
+        music_state_ = State::paused;
+    }
+
+    Mix_SetPostMix(nullptr, nullptr);
+    Mix_HaltChannel(-1);
+    reclaim_channels_();
+    Mix_CloseAudio();
+
+    if (open_device_(larger)) {
+        profile_ = larger;
+    } else if (!open_device_(profile_)) {
+        warn_sdl() << "Could not reopen audio device";
+        return;
+    }
+
+    Mix_ChannelFinished(&on_channel_finished);
+    start_audio_clock_();
+
+    if (music_was_playing) resume_music();
+}
+
 void Mixer::play_music(Music_track music)
 {
     attach_music(std::move(music));
@@ -207,20 +522,92 @@ Mixer::State Sound_effect_handle::get_state() const
     return ptr_->state;
 }
 
-int Mixer::find_empty_channel_() const
+int Mixer::find_empty_channel_() const noexcept
 {
     auto iter = std::find_if(channels_.begin(),
                              channels_.end(),
                              [](const auto& handle) {
                                  return handle.empty();
                              });
-    if (iter == channels_.end()) {
-        throw Mixer_error::out_of_channels();
-    }
+    if (iter == channels_.end()) return -1;
 
     return (int) std::distance(channels_.begin(), iter);
 }
 
+int Mixer::find_victim_channel_(int priority) const noexcept
+{
+    int victim = -1;
+    int victim_volume = 0;
+
+    int const channel_count = int(channels_.size());
+
+    for (int channel = 0; channel < channel_count; ++channel) {
+        const Voice_& voice = voices_[channel];
+        if (!channels_[channel] || voice.priority > priority) continue;
+
+        int volume = Mix_Volume(channel, -1);
+
+        if (victim < 0) {
+            victim = channel;
+            victim_volume = volume;
+            continue;
+        }
+
+        const Voice_& best = voices_[victim];
+        if (voice.priority != best.priority) {
+            if (voice.priority > best.priority) continue;
+        } else if (volume != victim_volume) {
+            if (volume > victim_volume) continue;
+        } else if (voice.order > best.order) {
+            continue;
+        }
+
+        victim = channel;
+        victim_volume = volume;
+    }
+
+    return victim;
+}
+
+bool Mixer::over_rate_limit_(const Sound_effect& effect) const noexcept
+{
+    if (effect_rate_limit_ == 0) return false;
+
+    int started = 0;
+
+    int const channel_count = int(channels_.size());
+
+    for (int channel = 0; channel < channel_count; ++channel) {
+        if (channels_[channel] &&
+            voices_[channel].frame == frame_ &&
+            channels_[channel].ptr_->effect.ptr_ == effect.ptr_) {
+            if (++started >= effect_rate_limit_) return true;
+        }
+    }
+
+    return false;
+}
+
+void Mixer::set_effect_rate_limit(int per_frame)
+{
+    if (per_frame < 0) {
+        throw Client_logic_error{"Mixer::set_effect_rate_limit: "
+                                 "limit must not be negative"};
+    }
+
+    effect_rate_limit_ = per_frame;
+}
+
+void Mixer::reclaim_channels_() noexcept
+{
+    int channel;
+    while (finished_channels.pop(channel)) {
+        if (channel >= 0 && size_t(channel) < channels_.size() &&
+            channels_[channel])
+            unregister_effect_(channel);
+    }
+}
+
 void Mixer::poll_channels_()
 {
     if (current_music_) {
@@ -244,21 +631,35 @@ void Mixer::poll_channels_()
         }
     }
 
-    for (int channel = 0; channel < channels_.size(); ++channel) {
-        if (channels_[channel] && !Mix_Playing(channel))
-        {
-            unregister_effect_(channel);
-        }
-    }
+    reclaim_channels_();
+    check_underruns_();
+    ++frame_;
 }
 
 Sound_effect_handle
-Mixer::play_effect(Sound_effect effect, double volume)
+Mixer::play_effect(Sound_effect effect, double volume, int priority)
 {
+    reclaim_channels_();
+
+    if (over_rate_limit_(effect)) return {};
+
     int channel = find_empty_channel_();
+
+    if (channel < 0) {
+        channel = find_victim_channel_(priority);
+        if (channel < 0) return {};
+
+        // Halting reports the channel finished right away, so reclaiming
+        // detaches the effect that was playing there.
+        Mix_HaltChannel(channel);
+        reclaim_channels_();
+        if (channels_[channel]) unregister_effect_(channel);
+    }
+
     Mix_Volume(channel, unit_to_volume(volume));
-    Mix_PlayChannel(channel, effect.ptr_.get(), 0);
-    return register_effect_(channel, std::move(effect));
+    if (Mix_PlayChannel(channel, effect.ptr_.get(), 0) < 0) return {};
+
+    return register_effect_(channel, std::move(effect), priority);
 }
 
 void Sound_effect_handle::resume()
@@ -308,13 +709,13 @@ void Sound_effect_handle::stop()
             throw Client_logic_error("Sound_effect_handle::stop: detached");
 
         case Mixer::State::paused:
-            ptr_->mixer.unregister_effect_(ptr_->channel);
-            Mix_HaltChannel(ptr_->channel);
-            break;
-
         case Mixer::State::playing:
-            ptr_->mixer.unregister_effect_(ptr_->channel);
+            // Halting reports the channel finished, and reclaiming it
+            // detaches this effect.
             Mix_HaltChannel(ptr_->channel);
+            ptr_->mixer.reclaim_channels_();
+            if (ptr_->state != Mixer::State::detached)
+                ptr_->mixer.unregister_effect_(ptr_->channel);
             break;
 
         case Mixer::State::fading_out:
@@ -348,10 +749,27 @@ int Mixer::available_effect_channels() const
 }
 
 Sound_effect_handle
-Mixer::register_effect_(int channel, Sound_effect effect)
+Mixer::register_effect_(int channel, Sound_effect effect, int priority)
 {
     assert(!channels_[channel]);
-    channels_[channel] = Sound_effect_handle(*this, std::move(effect), channel);
+
+    // Reuses the channel's last handle if no one else holds it, rather
+    // than allocating a new one.
+    Sound_effect_handle& spare = spare_handles_[channel];
+    if (spare && spare.ptr_.use_count() == 1) {
+        spare.ptr_->effect = std::move(effect);
+        spare.ptr_->state = State::playing;
+        channels_[channel] = std::move(spare);
+        spare = {};
+    } else {
+        channels_[channel] =
+                Sound_effect_handle(*this, std::move(effect), channel);
+    }
+
+    voices_[channel].priority = priority;
+    voices_[channel].frame = frame_;
+    voices_[channel].order = next_order_++;
+
     --available_effect_channels_;
     return channels_[channel];
 }
@@ -360,6 +778,7 @@ void Mixer::unregister_effect_(int channel)
 {
     assert(channels_[channel]);
     channels_[channel].ptr_->state = State::detached;
+    spare_handles_[channel] = std::move(channels_[channel]);
     channels_[channel] = {};
     ++available_effect_channels_;
 }
@@ -407,4 +826,18 @@ void Sound_effect_handle::set_volume(double unit_value)
 
 } // end namespace audio
 
+namespace detail {
+
+void poll_mixer(audio::Mixer& mixer)
+{
+    mixer.poll_channels_();
+}
+
+void check_mixer_underruns(audio::Mixer& mixer, unsigned long underruns)
+{
+    mixer.check_underruns_(underruns);
+}
+
+} // end namespace detail
+
 } // end namespace ge211
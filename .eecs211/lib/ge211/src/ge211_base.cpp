@@ -12,10 +12,21 @@ using namespace detail;
 const Dimensions Abstract_game::default_window_dimensions{800, 600};
 const char* const Abstract_game::default_window_title = "ge211 window";
 const Color Abstract_game::default_background_color = Color::black();
+const double Abstract_game::default_frame_rate = 60;
+const Duration Abstract_game::idle_wake_period = Duration(0.5);
+const Duration Abstract_game::prewarm_budget = Duration(0.5);
 
 // How many frames to run before calculating the frame rate.
 static int const frames_per_sample = 60;
 
+Abstract_game::Abstract_game()
+        : Abstract_game(audio::Audio_profile::standard())
+{ }
+
+Abstract_game::Abstract_game(const audio::Audio_profile& profile)
+        : mixer_(audio::Mixer::open_mixer(profile))
+{ }
+
 Dimensions Abstract_game::initial_window_dimensions() const
 {
     return default_window_dimensions;
@@ -44,6 +55,26 @@ Window& Abstract_game::get_window() const
                              "until engine is initialized"};
 }
 
+void Abstract_game::set_idle(bool idle) noexcept
+{
+    idle_ = idle;
+}
+
+void Abstract_game::set_target_frame_rate(double hz)
+{
+    if (hz < 0) {
+        throw Client_logic_error{"Abstract_game::set_target_frame_rate: "
+                                 "rate must not be negative"};
+    }
+
+    target_frame_rate_ = hz;
+}
+
+bool Abstract_game::is_key_down(Key key) const noexcept
+{
+    return engine_ && engine_->is_key_down(key);
+}
+
 Random& Abstract_game::get_random() const noexcept
 {
     return rng_;
@@ -56,7 +87,9 @@ audio::Mixer* Abstract_game::get_mixer() const noexcept
 
 void Abstract_game::prepare(const sprites::Sprite& sprite) const
 {
-    if (engine_)
+    if (!started_)
+        prewarm_queue_.push_back(&sprite);
+    else if (engine_)
         engine_->prepare(sprite);
     else {
         warn() << "Abstract_game::prepare: Could not prepare sprite "
@@ -64,9 +97,10 @@ void Abstract_game::prepare(const sprites::Sprite& sprite) const
     }
 }
 
-void Abstract_game::mark_frame_() noexcept
+void Abstract_game::mark_frame_(Duration busy_time) noexcept
 {
     prev_frame_length_ = frame_start_.reset();
+    prev_frame_busy_time_ = busy_time;
 
     if (! (fps_sample_count_ = (fps_sample_count_ + 1) % frames_per_sample))
         fps_ = frames_per_sample / fps_sample_start_.reset().seconds();
@@ -0,0 +1,225 @@
+#include "ge211_benchmark.h"
+#include "ge211_error.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+namespace ge211 {
+
+namespace detail {
+
+static const char* const frames_variable = "GE211_BENCHMARK";
+static const char* const script_variable = "GE211_BENCHMARK_SCRIPT";
+
+// How many of the slowest frames the report lists.
+static const size_t worst_frames_reported = 5;
+
+bool Benchmark::requested() noexcept
+{
+    const char* frames = std::getenv(frames_variable);
+    return frames != nullptr && *frames != '\0';
+}
+
+static int read_frame_count()
+{
+    const char* value = std::getenv(frames_variable);
+    char* end;
+    long frames = std::strtol(value, &end, 10);
+
+    if (*end != '\0' || frames <= 0 || frames > 100000000) {
+        throw Client_logic_error{std::string{frames_variable} +
+                                 ": expected a positive number of frames, "
+                                 "got “" + value + "”"};
+    }
+
+    return int(frames);
+}
+
+static bool parse_key(const std::string& name, Key& key)
+{
+    if (name.size() == 1) key = Key::code(name[0]);
+    else if (name == "up") key = Key::up();
+    else if (name == "down") key = Key::down();
+    else if (name == "left") key = Key::left();
+    else if (name == "right") key = Key::right();
+    else if (name == "space") key = Key::code(' ');
+    else if (name == "escape") key = Key::code('\u001B');
+    else if (name == "shift") key = Key::shift();
+    else if (name == "control") key = Key::control();
+    else if (name == "alt") key = Key::alt();
+    else if (name == "command") key = Key::command();
+    else return false;
+
+    return true;
+}
+
+static std::vector<Scripted_input> read_script(const std::string& path)
+{
+    using Kind = Scripted_input::Kind;
+
+    std::vector<Scripted_input> result;
+    std::ifstream in(path);
+
+    if (!in) {
+        throw Client_logic_error{std::string{script_variable} +
+                                 ": could not open “" + path + "”"};
+    }
+
+    std::string line;
+    int line_number = 0;
+
+    while (std::getline(in, line)) {
+        ++line_number;
+
+        std::istringstream words(line);
+        std::string event, key_name;
+        Scripted_input input;
+
+        words >> std::ws;
+        if (words.peek() == EOF || words.peek() == '#') continue;
+
+        bool ok = bool(words >> input.frame >> event) && input.frame >= 0;
+
+        if (!ok) {
+            // reported below
+        } else if (event == "down" || event == "up") {
+            input.kind = event == "down" ? Kind::key_down : Kind::key_up;
+            ok = (words >> key_name) && parse_key(key_name, input.key);
+        } else if (event == "click" || event == "press" ||
+                   event == "release" || event == "move") {
+            ok = bool(words >> input.position.x >> input.position.y);
+            input.button = Mouse_button::left;
+            input.kind = event == "move" ? Kind::mouse_move :
+                         event == "release" ? Kind::mouse_up :
+                         Kind::mouse_down;
+            if (ok && event == "click") {
+                result.push_back(input);
+                input.kind = Kind::mouse_up;
+            }
+        } else if (event == "quit") {
+            input.kind = Kind::quit;
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            throw Client_logic_error{path + ":" +
+                                     std::to_string(line_number) +
+                                     ": could not parse “" + line + "”"};
+        }
+
+        result.push_back(input);
+    }
+
+    std::stable_sort(result.begin(), result.end(),
+                     [](const Scripted_input& a, const Scripted_input& b) {
+                         return a.frame < b.frame;
+                     });
+
+    return result;
+}
+
+Benchmark::Benchmark()
+        : frame_count_{read_frame_count()}
+{
+    const char* script = std::getenv(script_variable);
+    if (script && *script)
+        script_ = read_script(script);
+
+    samples_.reserve(frame_count_);
+}
+
+void Benchmark::end_phase(Phase phase) noexcept
+{
+    current_[phase] = phase_timer_.reset().seconds();
+}
+
+bool Benchmark::end_frame()
+{
+    samples_.push_back(current_);
+    current_ = Sample{};
+
+    if (++frame_ < frame_count_) return false;
+
+    total_time_ = total_timer_.elapsed_time();
+    return true;
+}
+
+const char* Benchmark::phase_name(Phase phase)
+{
+    switch (phase) {
+        case events_phase: return "events";
+        case update_phase: return "update";
+        case draw_phase: return "draw";
+        case paint_phase: return "paint";
+        case present_phase: return "present";
+        default: return "total";
+    }
+}
+
+void Benchmark::report(std::ostream& out) const
+{
+    if (samples_.empty()) return;
+
+    auto frame_time = [](const Sample& sample) {
+        return std::accumulate(sample.begin(), sample.end(), 0.0);
+    };
+
+    // If the game quit early, the timer was never stopped.
+    double seconds = total_time_ > Duration(0) ?
+                     total_time_.seconds() :
+                     total_timer_.elapsed_time().seconds();
+    double n = double(samples_.size());
+
+    out << std::fixed << std::setprecision(3)
+        << "ge211 benchmark: " << samples_.size() << " frames in "
+        << seconds << " s (" << n / seconds << " fps)\n";
+
+    out << std::setw(10) << "phase"
+        << std::setw(12) << "mean ms"
+        << std::setw(12) << "max ms" << "\n";
+
+    for (int p = 0; p <= phase_count; ++p) {
+        double sum = 0, max = 0;
+        for (const Sample& sample : samples_) {
+            double t = p < phase_count ? sample[p] : frame_time(sample);
+            sum += t;
+            max = std::max(max, t);
+        }
+        out << std::setw(10) << phase_name(Phase(p))
+            << std::setw(12) << 1000 * sum / n
+            << std::setw(12) << 1000 * max << "\n";
+    }
+
+    std::vector<size_t> order(samples_.size());
+    std::iota(order.begin(), order.end(), size_t(0));
+    size_t worst_count = std::min(worst_frames_reported, order.size());
+    std::partial_sort(order.begin(), order.begin() + worst_count, order.end(),
+                      [&](size_t a, size_t b) {
+                          return frame_time(samples_[a]) >
+                                 frame_time(samples_[b]);
+                      });
+
+    out << "worst frames:\n";
+    for (size_t i = 0; i < worst_count; ++i) {
+        const Sample& sample = samples_[order[i]];
+        out << "  #" << std::setw(8) << std::left << order[i] << std::right
+            << std::setw(10) << 1000 * frame_time(sample) << " ms  (";
+        for (int p = 0; p < phase_count; ++p) {
+            out << (p ? ", " : "") << phase_name(Phase(p)) << " "
+                << 1000 * sample[p];
+        }
+        out << ")\n";
+    }
+
+    out.unsetf(std::ios::fixed);
+}
+
+} // end namespace detail
+
+}
@@ -0,0 +1,99 @@
+#include "ge211_camera.h"
+
+#include <cmath>
+
+namespace ge211 {
+
+namespace geometry {
+
+Camera::Camera(Rectangle viewport)
+        : viewport_{viewport}
+        , center_{viewport.x + viewport.width / 2.0,
+                  viewport.y + viewport.height / 2.0}
+{
+    if (viewport.width <= 0 || viewport.height <= 0)
+        throw Client_logic_error{"Camera: viewport must not be empty"};
+}
+
+Camera& Camera::set_center(Basic_position<double> center) noexcept
+{
+    center_ = center;
+    return *this;
+}
+
+Camera& Camera::pan(Basic_dimensions<double> distance) noexcept
+{
+    center_ += distance;
+    return *this;
+}
+
+Camera& Camera::set_zoom(double zoom)
+{
+    if (!(zoom > 0))
+        throw Client_logic_error{"Camera::set_zoom: zoom must be positive"};
+
+    zoom_ = zoom;
+    return *this;
+}
+
+// Keeps a view `extent` wide centered at `center` within [low, high).
+static double keep_within(double center, double extent, int low, int high)
+{
+    if (extent >= high - low) return (low + high) / 2.0;
+    return std::min(std::max(center, low + extent / 2), high - extent / 2);
+}
+
+Camera& Camera::keep_within(Rectangle world) noexcept
+{
+    center_.x = geometry::keep_within(center_.x, viewport_.width / zoom_,
+                                      world.x, world.x + world.width);
+    center_.y = geometry::keep_within(center_.y, viewport_.height / zoom_,
+                                      world.y, world.y + world.height);
+    return *this;
+}
+
+Basic_position<double> Camera::world_top_left_() const noexcept
+{
+    return {center_.x - viewport_.width / (2 * zoom_),
+            center_.y - viewport_.height / (2 * zoom_)};
+}
+
+Rectangle Camera::visible_area() const noexcept
+{
+    Basic_position<double> top_left = world_top_left_();
+
+    int left = int(std::floor(top_left.x));
+    int top = int(std::floor(top_left.y));
+    int right = int(std::ceil(top_left.x + viewport_.width / zoom_));
+    int bottom = int(std::ceil(top_left.y + viewport_.height / zoom_));
+
+    return {left, top, right - left, bottom - top};
+}
+
+bool Camera::can_see(Rectangle world) const noexcept
+{
+    return overlap(world, visible_area());
+}
+
+Position Camera::to_screen(Position world) const noexcept
+{
+    Basic_position<double> top_left = world_top_left_();
+    return {viewport_.x + int(std::floor((world.x - top_left.x) * zoom_)),
+            viewport_.y + int(std::floor((world.y - top_left.y) * zoom_))};
+}
+
+Position Camera::to_world(Position screen) const noexcept
+{
+    Basic_position<double> top_left = world_top_left_();
+    return {int(std::floor(top_left.x + (screen.x - viewport_.x) / zoom_)),
+            int(std::floor(top_left.y + (screen.y - viewport_.y) / zoom_))};
+}
+
+Transform Camera::transform() const noexcept
+{
+    return Transform::scale(zoom_);
+}
+
+} // end namespace geometry
+
+}
@@ -1,5 +1,7 @@
 #include "ge211_engine.h"
 #include "ge211_base.h"
+#include "ge211_benchmark.h"
+#include "ge211_recorder.h"
 #include "ge211_render.h"
 #include "ge211_sprites.h"
 
@@ -8,17 +10,56 @@
 
 #include <algorithm>
 #include <cstring>
+#include <iostream>
+#include <memory>
 
 namespace ge211 {
 
 namespace detail {
 
-// Used to control the frame rate if we have to fallback to
-// software rendering, or for when the window is hidden (and
-// vsync stops working).
-static const int software_fps = 60;
-static const Duration software_frame_length = Duration(1) / software_fps;
-static const Duration min_frame_length = software_frame_length / 2;
+const Duration Frame_pacer::spin_margin = Duration(0.002);
+
+Frame_pacer::Frame_pacer() noexcept
+        : deadline_{Time_point::now()}
+{ }
+
+void Frame_pacer::reset() noexcept
+{
+    deadline_ = Time_point::now();
+}
+
+Duration Frame_pacer::wait(Duration frame_length)
+{
+    Time_point start = Time_point::now();
+
+    if (frame_length <= Duration(0)) {
+        deadline_ = start;
+        return Duration(0);
+    }
+
+    deadline_ += frame_length;
+
+    if (start >= deadline_) {
+        // If we've fallen more than a frame behind, catching up would
+        // mean a burst of frames with no waiting at all, so we start the
+        // schedule over instead.
+        if (start - deadline_ > frame_length)
+            deadline_ = start;
+        return Duration(0);
+    }
+
+    Duration remaining = deadline_ - start;
+    if (remaining > spin_margin)
+        (remaining - spin_margin).sleep_for();
+
+    Time_point now = Time_point::now();
+    while (now < deadline_) {
+        std::this_thread::yield();
+        now = Time_point::now();
+    }
+
+    return now - start;
+}
 
 Engine::Engine(Abstract_game& game)
         : game_{game},
@@ -38,6 +79,28 @@ void Engine::prepare(const sprites::Sprite& sprite) const
     sprite.prepare(renderer_);
 }
 
+void Engine::prewarm_()
+{
+    std::vector<const sprites::Sprite*>& queue = game_.prewarm_queue_;
+    Timer timer;
+    size_t prepared = 0;
+
+    while (prepared < queue.size() &&
+           timer.elapsed_time() < Abstract_game::prewarm_budget) {
+        queue[prepared++]->prepare(renderer_);
+    }
+
+    if (prepared < queue.size()) {
+        info() << "Prepared " << prepared << " of " << queue.size()
+               << " sprites before the first frame; the rest will be "
+               << "prepared when first rendered";
+    }
+
+    queue.clear();
+    queue.shrink_to_fit();
+    game_.started_ = true;
+}
+
 void Engine::run()
 {
     SDL_Event e;
@@ -46,45 +109,220 @@ void Engine::run()
     bool has_vsync = renderer_.is_vsync();
 
     try {
+        std::unique_ptr<Benchmark> benchmark;
+        if (Benchmark::requested())
+            benchmark = std::make_unique<Benchmark>();
+
+        auto end_phase = [&](Benchmark::Phase phase) {
+            if (benchmark) benchmark->end_phase(phase);
+        };
+
         game_.on_start();
+        prewarm_();
+
+        // After on_start, which may resize the window.
+        std::unique_ptr<Recorder> recorder;
+        if (Recorder::requested()) {
+            recorder = std::make_unique<Recorder>(
+                    renderer_.output_dimensions(),
+                    game_.target_frame_rate_);
+        }
+
+        pacer_.reset();
 
         while (!game_.quit_) {
-            handle_events_(e);
+            // Benchmarks never idle, since they have frames to count.
+            bool was_idle = is_idle_() && !benchmark;
+            if (was_idle)
+                wait_while_idle_();
+
+            if (benchmark) {
+                benchmark->play_input([&](const Scripted_input& input) {
+                    play_input_(input);
+                });
+            }
+            bool had_events = handle_events_(e);
+            latch_keyboard_();
+            end_phase(Benchmark::events_phase);
+
             game_.on_frame(game_.get_prev_frame_length().seconds());
-            if (game_.mixer_) game_.mixer_->poll_channels_();
+            if (game_.mixer_) poll_mixer(*game_.mixer_);
+            end_phase(Benchmark::update_phase);
+
+            // Waking up for nothing but the timeout, with the game still
+            // idle, leaves nothing new to draw.
+            if (was_idle && !had_events && is_idle_())
+                continue;
+
             game_.draw(sprites);
+            end_phase(Benchmark::draw_phase);
 
             renderer_.set_color(game_.background_color);
             renderer_.clear();
-            paint_sprites_(sprites);
-            renderer_.present();
+            sprites.paint_(renderer_);
+            if (recorder) recorder->capture(renderer_);
+            end_phase(Benchmark::paint_phase);
+
+            // Everything after this is waiting for the display.
+            Duration busy_time = game_.frame_start_.elapsed_time();
 
-            Duration allowed_frame_length =
-                    (is_focused_ && has_vsync)?
-                    min_frame_length : software_frame_length;
+            renderer_.present();
+            measure_latency_();
+            end_phase(Benchmark::present_phase);
+
+            double target_rate = game_.target_frame_rate_;
+            Duration frame_length = target_rate > 0 ?
+                                    Duration(1) / target_rate :
+                                    Duration(0);
+
+            // With vsync, presenting already waits for the display, so
+            // the pacer only keeps us from running away when vsync stops
+            // working (e.g., when the window is hidden).
+            if (is_focused_ && has_vsync)
+                frame_length /= 2;
+
+            // Benchmarks run flat out, for a fixed number of frames.
+            if (benchmark) {
+                frame_length = Duration(0);
+                if (benchmark->end_frame()) game_.quit();
+            }
 
-            auto frame_length = game_.frame_start_.elapsed_time();
-            if (frame_length < allowed_frame_length) {
-                auto duration = allowed_frame_length - frame_length;
-                duration.sleep_for();
-                game_.mark_frame_();
-                debug() << "Software vsync slept for "
+            auto duration = pacer_.wait(frame_length);
+            game_.mark_frame_(busy_time);
+            if (duration > Duration(0)) {
+                debug() << "Frame pacer waited for "
                         << duration.seconds() << " s";
-            } else {
-                game_.mark_frame_();
             }
         }
 
         game_.on_quit();
+
+        if (benchmark) benchmark->report(std::cout);
     } catch (const Exception_base& e) {
         fatal() << "Uncaught exception:\n  " << e.what();
         exit(1);
     }
 }
 
-void Engine::handle_events_(SDL_Event& e)
+bool Engine::is_idle_() const noexcept
 {
+    return game_.idle_ || focus_lost_;
+}
+
+void Engine::wait_while_idle_()
+{
+    // Waiting with a null event leaves the event in the queue for
+    // handle_events_.
+    SDL_WaitEventTimeout(nullptr,
+                         int(game_.idle_wake_period.milliseconds()));
+
+    // Time spent waiting is not part of any frame, and the pacer
+    // shouldn't try to make up for it.
+    game_.frame_start_.reset();
+    pacer_.reset();
+}
+
+bool Engine::is_key_down(Key key) const noexcept
+{
+    if (std::find(scripted_keys_.begin(), scripted_keys_.end(), key) !=
+        scripted_keys_.end())
+        return true;
+
+    return detail::is_key_down(key, keyboard_.data(), int(keyboard_.size()));
+}
+
+void Engine::latch_keyboard_()
+{
+    int length;
+    const uint8_t* state = SDL_GetKeyboardState(&length);
+    keyboard_.assign(state, state + length);
+}
+
+void Engine::note_input_(uint32_t timestamp) noexcept
+{
+    // SDL timestamps are milliseconds since SDL started, like
+    // SDL_GetTicks(). Unsigned subtraction handles wraparound.
+    uint32_t age_ms = SDL_GetTicks() - timestamp;
+    game_.event_time_ = Time_point::now() - Duration(age_ms / 1000.0);
+
+    if (!frame_has_input_) {
+        frame_has_input_ = true;
+        first_input_time_ = game_.event_time_;
+    }
+}
+
+void Engine::measure_latency_() noexcept
+{
+    if (!frame_has_input_) return;
+
+    frame_has_input_ = false;
+    game_.input_latency_ = Time_point::now() - first_input_time_;
+    debug() << "Input-to-present latency: "
+            << game_.input_latency_.seconds() * 1000 << " ms";
+}
+
+void Engine::play_input_(const Scripted_input& input)
+{
+    using Kind = Scripted_input::Kind;
+
+    note_input_(SDL_GetTicks());
+
+    switch (input.kind) {
+        case Kind::key_down:
+            if (std::find(scripted_keys_.begin(), scripted_keys_.end(),
+                          input.key) == scripted_keys_.end())
+                scripted_keys_.push_back(input.key);
+            game_.on_key_down(input.key);
+            game_.on_key(input.key);
+            break;
+
+        case Kind::key_up:
+            scripted_keys_.erase(std::remove(scripted_keys_.begin(),
+                                             scripted_keys_.end(),
+                                             input.key),
+                                 scripted_keys_.end());
+            game_.on_key_up(input.key);
+            break;
+
+        case Kind::mouse_down:
+            game_.on_mouse_down(input.button, input.position);
+            break;
+
+        case Kind::mouse_up:
+            game_.on_mouse_up(input.button, input.position);
+            break;
+
+        case Kind::mouse_move:
+            game_.on_mouse_move(input.position);
+            break;
+
+        case Kind::quit:
+            game_.quit();
+            break;
+    }
+}
+
+bool Engine::handle_events_(SDL_Event& e)
+{
+    bool any = false;
+
     while (SDL_PollEvent(&e) != 0) {
+        any = true;
+
+        switch (e.type) {
+            case SDL_TEXTINPUT:
+            case SDL_KEYDOWN:
+            case SDL_KEYUP:
+            case SDL_MOUSEBUTTONDOWN:
+            case SDL_MOUSEBUTTONUP:
+            case SDL_MOUSEMOTION:
+                note_input_(e.common.timestamp);
+                break;
+
+            default:
+                ;
+        }
+
         switch (e.type) {
             case SDL_QUIT:
                 game_.quit();
@@ -139,10 +377,22 @@ void Engine::handle_events_(SDL_Event& e)
                 switch (e.window.event) {
                     case SDL_WINDOWEVENT_FOCUS_GAINED:
                         is_focused_ = true;
+                        if (focus_lost_) {
+                            focus_lost_ = false;
+                            game_.on_focus_gained();
+                        }
                         break;
 
                     case SDL_WINDOWEVENT_FOCUS_LOST:
                         is_focused_ = false;
+                        if (!focus_lost_) {
+                            focus_lost_ = true;
+                            game_.on_focus_lost();
+                        }
+                        break;
+
+                    case SDL_WINDOWEVENT_SIZE_CHANGED:
+                        renderer_.invalidate_targets();
                         break;
 
                     default:
@@ -150,22 +400,17 @@ void Engine::handle_events_(SDL_Event& e)
                 }
                 break;
 
+            case SDL_RENDER_TARGETS_RESET:
+            case SDL_RENDER_DEVICE_RESET:
+                renderer_.invalidate_targets();
+                break;
+
             default:
                 ;
         }
     }
-}
 
-void Engine::paint_sprites_(Sprite_set& sprite_set)
-{
-    auto& sprites = sprite_set.sprites_;
-    std::make_heap(sprites.begin(), sprites.end());
-
-    while (!sprites.empty()) {
-        std::pop_heap(sprites.begin(), sprites.end());
-        sprites.back().render(renderer_);
-        sprites.pop_back();
-    }
+    return any;
 }
 
 Window& Engine::get_window() noexcept
@@ -4,7 +4,17 @@
 #include <SDL_image.h>
 #include <SDL_ttf.h>
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
 #include <iostream>
+#include <mutex>
+#include <new>
+#include <system_error>
+#include <thread>
+#include <type_traits>
 
 namespace ge211 {
 
@@ -88,6 +98,11 @@ Mixer_error Mixer_error::out_of_channels()
     return Mixer_error("Could not play effect: out of channels");
 }
 
+Mixer_error Mixer_error::could_not_load_samples()
+{
+    return Mixer_error("Could not load effect from samples");
+}
+
 }
 
 namespace detail {
@@ -110,39 +125,282 @@ static const char* log_level_string(Log_level level)
     return "<unknown>";
 }
 
+#if GE211_MIN_LOG_LEVEL <= 0
 Log_message debug(std::string reason)
 {
     return Log_message{std::move(reason), Log_level::debug};
 }
+#endif
 
+#if GE211_MIN_LOG_LEVEL <= 1
 Log_message info(std::string reason)
 {
     return Log_message{std::move(reason), Log_level::info};
 }
 
+Log_message info_sdl()
+{
+    return info(SDL_GetError());
+}
+#endif
+
+#if GE211_MIN_LOG_LEVEL <= 2
 Log_message warn(std::string reason)
 {
     return Log_message{std::move(reason), Log_level::warn};
 }
 
+Log_message warn_sdl()
+{
+    return warn(SDL_GetError());
+}
+#endif
+
 Log_message fatal(std::string reason)
 {
     return Log_message{std::move(reason), Log_level::fatal};
 }
 
-Log_message info_sdl()
+Log_message fatal_sdl()
 {
-    return info(SDL_GetError());
+    return fatal(SDL_GetError());
 }
 
-Log_message warn_sdl()
+// The ring buffer behind Logger. It is a bounded queue in the style of
+// Dmitry Vyukov's: every slot carries a sequence number that tells
+// producers when it is free and the consumer when it is full, so
+// producers claim slots with a single compare-and-swap and never wait
+// on each other or on the consumer. There is one consumer at a time,
+// the background thread or a flush, serialized by consumer_mutex_.
+class Log_ring
 {
-    return warn(SDL_GetError());
+public:
+    Log_ring();
+
+    // Stops the background thread and writes whatever it left behind.
+    // Messages after this are written as they come.
+    void stop() noexcept;
+
+    // Adds a message, truncated to fit a slot. Returns false if the
+    // buffer is full.
+    bool push(const std::string&) noexcept;
+
+    // Writes everything queued so far.
+    void drain() noexcept;
+
+    unsigned long dropped() const noexcept
+    {
+        return dropped_.load(std::memory_order_relaxed);
+    }
+
+    bool has_thread() const noexcept
+    {
+        return running_.load();
+    }
+
+private:
+    static const size_t slot_count = 256;
+    static const size_t slot_size = 512;
+
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        size_t length;
+        char text[slot_size];
+    };
+
+    // Requires consumer_mutex_.
+    bool pop_(std::string&) noexcept;
+    bool is_empty_() const noexcept;
+    void drain_locked_() noexcept;
+    void run_();
+
+    std::unique_ptr<Slot[]> slots_{new Slot[slot_count]};
+    alignas(64) std::atomic<size_t> enqueue_pos_{0};
+    alignas(64) size_t dequeue_pos_ = 0;
+    std::atomic<unsigned long> dropped_{0};
+    unsigned long dropped_reported_ = 0;
+
+    std::mutex consumer_mutex_;
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> running_{false};
+
+    // The background thread waits on wake_ while the buffer is empty,
+    // after setting sleeping_, so producers only take wake_mutex_ when
+    // there is someone to wake.
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::atomic<bool> sleeping_{false};
+
+    std::thread thread_;
+};
+
+const size_t Log_ring::slot_count;
+const size_t Log_ring::slot_size;
+
+Log_ring::Log_ring()
+{
+    for (size_t i = 0; i < slot_count; ++i)
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+
+    try {
+        thread_ = std::thread{[this] { run_(); }};
+        running_.store(true);
+    } catch (const std::system_error&) {
+        // Without a thread, Logger::write drains after every push.
+    }
 }
 
-Log_message fatal_sdl()
+void Log_ring::stop() noexcept
 {
-    return fatal(SDL_GetError());
+    // Writers that still see the thread running pushed before this, so
+    // the drain below gets their messages.
+    running_.store(false);
+
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stopping_.store(true, std::memory_order_relaxed);
+    }
+    wake_.notify_one();
+
+    if (thread_.joinable()) thread_.join();
+    drain();
+}
+
+bool Log_ring::push(const std::string& message) noexcept
+{
+    size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+    Slot* slot;
+
+    for (;;) {
+        slot = &slots_[pos % slot_count];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        auto diff = std::ptrdiff_t(sequence) - std::ptrdiff_t(pos);
+
+        if (diff == 0) {
+            if (enqueue_pos_.compare_exchange_weak(
+                    pos, pos + 1, std::memory_order_relaxed))
+                break;
+        } else if (diff < 0) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = enqueue_pos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->length = std::min(message.size(), slot_size);
+    std::memcpy(slot->text, message.data(), slot->length);
+    // A truncated message still ends the line.
+    if (message.size() > slot_size) slot->text[slot_size - 1] = '\n';
+
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    // Pairs with the fence in run_(): either the thread sees this
+    // message before it waits, or we see that it is waiting.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+        { std::lock_guard<std::mutex> lock(wake_mutex_); }
+        wake_.notify_one();
+    }
+
+    return true;
+}
+
+bool Log_ring::pop_(std::string& out) noexcept
+{
+    Slot& slot = slots_[dequeue_pos_ % slot_count];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+    if (std::ptrdiff_t(sequence) - std::ptrdiff_t(dequeue_pos_ + 1) < 0)
+        return false;
+
+    out.assign(slot.text, slot.length);
+    slot.sequence.store(dequeue_pos_ + slot_count, std::memory_order_release);
+    ++dequeue_pos_;
+    return true;
+}
+
+bool Log_ring::is_empty_() const noexcept
+{
+    const Slot& slot = slots_[dequeue_pos_ % slot_count];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    return std::ptrdiff_t(sequence) - std::ptrdiff_t(dequeue_pos_ + 1) < 0;
+}
+
+void Log_ring::drain_locked_() noexcept
+{
+    std::string message;
+    bool wrote = false;
+
+    while (pop_(message)) {
+        std::cerr << message;
+        wrote = true;
+    }
+
+    unsigned long dropped = this->dropped();
+    if (dropped != dropped_reported_) {
+        std::cerr << "ge211[warn]: " << dropped - dropped_reported_
+                  << " log messages dropped\n";
+        dropped_reported_ = dropped;
+        wrote = true;
+    }
+
+    if (wrote) std::cerr.flush();
+}
+
+void Log_ring::drain() noexcept
+{
+    std::lock_guard<std::mutex> lock(consumer_mutex_);
+    drain_locked_();
+}
+
+void Log_ring::run_()
+{
+    std::unique_lock<std::mutex> wake_lock(wake_mutex_);
+
+    while (!stopping_.load(std::memory_order_relaxed)) {
+        wake_lock.unlock();
+        drain();
+        wake_lock.lock();
+
+        // Blocks, rather than polling, so an idle game's process really
+        // is idle.
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wake_.wait(wake_lock, [this] {
+            if (stopping_.load(std::memory_order_relaxed)) return true;
+            std::lock_guard<std::mutex> lock(consumer_mutex_);
+            return !is_empty_();
+        });
+        sleeping_.store(false, std::memory_order_relaxed);
+    }
+}
+
+static void stop_log_ring() noexcept;
+
+// Never destroyed, so that static destructors can still log. The thread
+// is stopped at exit, after everything constructed since, and messages
+// from then on are written directly.
+static Log_ring& make_log_ring()
+{
+    // Before C++17, new doesn't promise the ring's alignment.
+    static std::aligned_storage<sizeof(Log_ring), alignof(Log_ring)>::type
+            storage;
+    Log_ring* ring = new (&storage) Log_ring;
+    std::atexit(&stop_log_ring);
+    return *ring;
+}
+
+static Log_ring& log_ring()
+{
+    static Log_ring& ring = make_log_ring();
+    return ring;
+}
+
+static void stop_log_ring() noexcept
+{
+    log_ring().stop();
 }
 
 Logger& Logger::instance() noexcept
@@ -151,9 +409,34 @@ Logger& Logger::instance() noexcept
     return instance;
 }
 
+void Logger::write(const std::string& message) noexcept
+{
+    Log_ring& ring = log_ring();
+    ring.push(message);
+    if (!ring.has_thread()) ring.drain();
+}
+
+void Logger::write_now(const std::string& message) noexcept
+{
+    Log_ring& ring = log_ring();
+    ring.drain();
+    std::cerr << message << std::flush;
+}
+
+void Logger::flush() noexcept
+{
+    log_ring().drain();
+}
+
+unsigned long Logger::dropped() const noexcept
+{
+    return log_ring().dropped();
+}
+
 Log_message::Log_message(std::string reason, Log_message::Level level) noexcept
         : reason_{std::move(reason)}
         , message_{}
+        , level_{level}
         , active_{level >= Logger::instance().level()}
 {
     if (active_)
@@ -167,13 +450,16 @@ Log_message::Log_message(Log_message::Level level)
 Log_message::~Log_message()
 {
     if (active_) {
-        std::cerr << message_.str();
-        if (!reason_.empty()) std::cerr << "\n  (Reason: " << reason_ << ")";
-        std::cerr << std::endl;
+        if (!reason_.empty()) message_ << "\n  (Reason: " << reason_ << ")";
+        message_ << '\n';
+
+        if (level_ == Level::fatal)
+            Logger::instance().write_now(message_.str());
+        else
+            Logger::instance().write(message_.str());
     }
 }
 
 } // end namespace detail
 
 }
-
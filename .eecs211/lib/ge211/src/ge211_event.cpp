@@ -26,6 +26,51 @@ bool map_button(uint8_t input, Mouse_button& output) noexcept
     }
 }
 
+static bool is_keycode_down(SDL_Keycode code,
+                            const uint8_t* state,
+                            int length) noexcept
+{
+    SDL_Scancode scancode = SDL_GetScancodeFromKey(code);
+    return scancode != SDL_SCANCODE_UNKNOWN &&
+           scancode < length &&
+           state[scancode];
+}
+
+bool is_key_down(Key key, const uint8_t* state, int length) noexcept
+{
+    auto down = [=](SDL_Keycode code) {
+        return is_keycode_down(code, state, length);
+    };
+
+    switch (key.type()) {
+        case Key::Type::code: {
+            char32_t c = key.code();
+            // Only ASCII characters have keys of their own.
+            if (c >= 128) return false;
+            if (c == '\r' && down(SDLK_KP_ENTER)) return true;
+            return down(SDL_Keycode(std::tolower(int(c))));
+        }
+        case Key::Type::up:
+            return down(SDLK_UP);
+        case Key::Type::down:
+            return down(SDLK_DOWN);
+        case Key::Type::left:
+            return down(SDLK_LEFT);
+        case Key::Type::right:
+            return down(SDLK_RIGHT);
+        case Key::Type::shift:
+            return down(SDLK_LSHIFT) || down(SDLK_RSHIFT);
+        case Key::Type::control:
+            return down(SDLK_LCTRL) || down(SDLK_RCTRL);
+        case Key::Type::alt:
+            return down(SDLK_LALT) || down(SDLK_RALT);
+        case Key::Type::command:
+            return down(SDLK_LGUI) || down(SDLK_RGUI);
+        default:
+            return false;
+    }
+}
+
 } // end namespace detail
 
 namespace events {
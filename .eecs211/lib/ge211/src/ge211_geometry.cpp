@@ -8,7 +8,7 @@ namespace geometry {
 
 Transform::Transform() noexcept
         : rotation_{0}, scale_x_{1.0}, scale_y_{1.0},
-          flip_h_{false}, flip_v_{false}
+          tint_{Color::white()}, flip_h_{false}, flip_v_{false}
 { }
 
 Transform Transform::rotation(double degrees) noexcept
@@ -41,6 +41,11 @@ Transform Transform::scale_y(double factor) noexcept
     return Transform().set_scale_y(factor);
 }
 
+Transform Transform::tint(Color color) noexcept
+{
+    return Transform().set_tint(color);
+}
+
 Transform& Transform::set_rotation(double rotation) noexcept
 {
     while (rotation < 0) rotation += 360;
@@ -79,6 +84,12 @@ Transform& Transform::set_scale_y(double scale_y) noexcept
     return *this;
 }
 
+Transform& Transform::set_tint(Color color) noexcept
+{
+    tint_ = color;
+    return *this;
+}
+
 double Transform::get_rotation() const noexcept
 {
     return rotation_;
@@ -104,11 +115,28 @@ double Transform::get_scale_y() const noexcept
     return scale_y_;
 }
 
+Color Transform::get_tint() const noexcept
+{
+    return tint_;
+}
+
 bool Transform::is_identity() const noexcept
 {
     return *this == Transform();
 }
 
+bool Transform::is_untransformed() const noexcept
+{
+    return rotation_ == 0 && scale_x_ == 1 && scale_y_ == 1 &&
+           !flip_h_ && !flip_v_;
+}
+
+// Multiplies two color components as fractions of 255, rounding.
+static uint8_t multiply_component(uint8_t c1, uint8_t c2) noexcept
+{
+    return uint8_t((c1 * c2 + 127) / 255);
+}
+
 Transform Transform::operator*(const Transform& other) const noexcept
 {
     Transform result;
@@ -117,6 +145,10 @@ Transform Transform::operator*(const Transform& other) const noexcept
     result.set_flip_v(flip_v_ ^ other.flip_v_);
     result.set_scale_x(scale_x_ * other.scale_x_);
     result.set_scale_y(scale_y_ * other.scale_y_);
+    result.set_tint({multiply_component(tint_.red(), other.tint_.red()),
+                     multiply_component(tint_.green(), other.tint_.green()),
+                     multiply_component(tint_.blue(), other.tint_.blue()),
+                     multiply_component(tint_.alpha(), other.tint_.alpha())});
     return result;
 }
 
@@ -137,7 +169,8 @@ bool operator==(const Transform& t1, const Transform& t2) noexcept
             t1.get_flip_h() == t2.get_flip_h() &&
             t1.get_flip_v() == t2.get_flip_v() &&
             t1.get_scale_x() == t2.get_scale_x() &&
-            t1.get_scale_y() == t2.get_scale_y();
+            t1.get_scale_y() == t2.get_scale_y() &&
+            t1.get_tint() == t2.get_tint();
 }
 
 bool operator!=(const Transform& t1, const Transform& t2) noexcept
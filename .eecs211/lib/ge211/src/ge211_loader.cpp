@@ -0,0 +1,106 @@
+#include "ge211_loader.h"
+
+#include <algorithm>
+
+namespace ge211 {
+
+using namespace sprites;
+
+unsigned Loader::default_thread_count() noexcept
+{
+    unsigned processors = std::thread::hardware_concurrency();
+    return std::max(processors, 2u) - 1;
+}
+
+Loader::Loader(unsigned thread_count)
+{
+    thread_count = std::max(thread_count, 1u);
+
+    for (unsigned i = 0; i < thread_count; ++i)
+        threads_.emplace_back([this] { work_(); });
+}
+
+Loader::~Loader()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+
+    work_ready_.notify_all();
+
+    for (std::thread& thread : threads_)
+        thread.join();
+}
+
+std::future<Font> Loader::load_font(const std::string& filename, int size)
+{
+    return run([=] { return Font(filename, size); });
+}
+
+std::future<Image_sprite> Loader::load_image(const std::string& filename)
+{
+    return run([=] { return Image_sprite(filename); });
+}
+
+std::future<Circle_sprite> Loader::make_circle(int radius, Color color)
+{
+    return run([=] { return Circle_sprite(radius, color); });
+}
+
+std::future<Rectangle_sprite>
+Loader::make_rectangle(Dimensions dimensions, Color color)
+{
+    return run([=] { return Rectangle_sprite(dimensions, color); });
+}
+
+void Loader::wait()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    all_done_.wait(lock, [this] { return queue_.empty() && running_ == 0; });
+}
+
+size_t Loader::pending() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size() + running_;
+}
+
+void Loader::submit_(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(std::move(job));
+    }
+
+    work_ready_.notify_one();
+}
+
+// Runs jobs until the loader is stopping and there are none left.
+void Loader::work_()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (;;) {
+        work_ready_.wait(lock, [this] {
+            return stopping_ || !queue_.empty();
+        });
+
+        if (queue_.empty()) return;
+
+        std::function<void()> job = std::move(queue_.front());
+        queue_.pop_front();
+        ++running_;
+
+        // A packaged_task stores any exception in its future, so the job
+        // itself doesn't throw.
+        lock.unlock();
+        job();
+        lock.lock();
+
+        if (--running_ == 0 && queue_.empty())
+            all_done_.notify_all();
+    }
+}
+
+}
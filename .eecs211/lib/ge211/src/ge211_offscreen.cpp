@@ -0,0 +1,132 @@
+#include "ge211_offscreen.h"
+#include "ge211_error.h"
+
+#include <SDL.h>
+#include <SDL_image.h>
+
+#include <algorithm>
+
+namespace ge211 {
+
+using namespace detail;
+
+static void check_bounds(Position position, Dimensions dimensions,
+                         const char* who)
+{
+    if (position.x < 0 || position.x >= dimensions.width ||
+        position.y < 0 || position.y >= dimensions.height) {
+        throw Client_logic_error{std::string(who) + ": position out of bounds"};
+    }
+}
+
+static Color read_color(const uint8_t* pixel) noexcept
+{
+    return Color(pixel[0], pixel[1], pixel[2], pixel[3]);
+}
+
+// Copies rows of RGBA32 pixels, dropping any padding.
+static void copy_rows(const uint8_t* from, int pitch, Rgba_image& to)
+{
+    size_t row_bytes = 4 * size_t(to.dimensions.width);
+    to.pixels.resize(row_bytes * to.dimensions.height);
+
+    for (int y = 0; y < to.dimensions.height; ++y) {
+        std::copy(from + y * pitch, from + y * pitch + row_bytes,
+                  to.pixels.begin() + y * row_bytes);
+    }
+}
+
+Color Rgba_image::get_pixel(Position position) const
+{
+    check_bounds(position, dimensions, "Rgba_image::get_pixel");
+    return read_color(&pixels[4 * (position.y * dimensions.width +
+                                   position.x)]);
+}
+
+Rgba_image Rgba_image::load(const std::string& path)
+{
+    delete_ptr<SDL_Surface> loaded{IMG_Load(path.c_str()), &SDL_FreeSurface};
+    if (!loaded) throw Image_error::could_not_load(path);
+
+    delete_ptr<SDL_Surface> converted{
+            SDL_ConvertSurfaceFormat(loaded.get(), SDL_PIXELFORMAT_RGBA32, 0),
+            &SDL_FreeSurface};
+    if (!converted) throw Image_error::could_not_load(path);
+
+    Rgba_image result;
+    result.dimensions = {converted->w, converted->h};
+
+    if (SDL_LockSurface(converted.get()) < 0)
+        throw Image_error::could_not_load(path);
+    copy_rows(static_cast<const uint8_t*>(converted->pixels),
+              converted->pitch, result);
+    SDL_UnlockSurface(converted.get());
+
+    return result;
+}
+
+void Rgba_image::save_png(const std::string& path) const
+{
+    // SDL only reads the pixels, despite the non-const pointer.
+    delete_ptr<SDL_Surface> surface{
+            SDL_CreateRGBSurfaceWithFormatFrom(
+                    const_cast<uint8_t*>(pixels.data()),
+                    dimensions.width, dimensions.height, 32,
+                    4 * dimensions.width, SDL_PIXELFORMAT_RGBA32),
+            &SDL_FreeSurface};
+
+    if (!surface || IMG_SavePNG(surface.get(), path.c_str()) < 0)
+        throw Host_error{"Could not save " + path};
+}
+
+Offscreen_renderer::Offscreen_renderer(Dimensions dimensions)
+        : renderer_{dimensions}
+{ }
+
+void Offscreen_renderer::prepare(const sprites::Sprite& sprite) const
+{
+    sprite.prepare(renderer_);
+}
+
+void Offscreen_renderer::paint_()
+{
+    renderer_.set_color(background_color);
+    renderer_.clear();
+    sprites_.paint_(renderer_);
+
+    // The software renderer may queue drawing until it presents.
+    renderer_.present();
+}
+
+Dimensions Offscreen_renderer::get_dimensions() const noexcept
+{
+    const SDL_Surface* framebuffer = renderer_.get_framebuffer();
+    return {framebuffer->w, framebuffer->h};
+}
+
+Color Offscreen_renderer::get_pixel(Position position) const
+{
+    check_bounds(position, get_dimensions(), "Offscreen_renderer::get_pixel");
+    return read_color(get_pixels() + position.y * get_pitch()
+                      + 4 * position.x);
+}
+
+const uint8_t* Offscreen_renderer::get_pixels() const noexcept
+{
+    return static_cast<const uint8_t*>(renderer_.get_framebuffer()->pixels);
+}
+
+int Offscreen_renderer::get_pitch() const noexcept
+{
+    return renderer_.get_framebuffer()->pitch;
+}
+
+Rgba_image Offscreen_renderer::snapshot() const
+{
+    Rgba_image result;
+    result.dimensions = get_dimensions();
+    copy_rows(get_pixels(), get_pitch(), result);
+    return result;
+}
+
+}
@@ -0,0 +1,214 @@
+#include "ge211_pack.h"
+#include "ge211_error.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+#if defined(__unix__) || defined(__APPLE__)
+#  define GE211_PACK_MMAP 1
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#else
+#  define GE211_PACK_MMAP 0
+#endif
+
+namespace ge211 {
+
+namespace detail {
+
+const char Resource_pack::magic[8] = {'G', 'E', '2', '1', '1', 'P', 'A', 'K'};
+const uint32_t Resource_pack::version;
+const size_t Resource_pack::header_size;
+const size_t Resource_pack::entry_size;
+const size_t Resource_pack::pack_alignment;
+const char* const Resource_pack::default_filename = "Resources.ge211pack";
+
+static const char* const pack_variable = "GE211_RESOURCE_PACK";
+
+static const char* pack_search_prefixes[] = {
+        "",
+        "../",
+};
+
+static uint32_t read_u32(const unsigned char* p) noexcept
+{
+    return uint32_t(p[0])
+           | uint32_t(p[1]) << 8
+           | uint32_t(p[2]) << 16
+           | uint32_t(p[3]) << 24;
+}
+
+static uint64_t read_u64(const unsigned char* p) noexcept
+{
+    return uint64_t(read_u32(p)) | uint64_t(read_u32(p + 4)) << 32;
+}
+
+static std::unique_ptr<Resource_pack> open_default_pack()
+{
+    std::unique_ptr<Resource_pack> result;
+
+    const char* path = std::getenv(pack_variable);
+    if (path && *path) {
+        result.reset(new Resource_pack(path));
+        if (result->empty()) {
+            warn() << pack_variable << ": could not load resource pack "
+                   << path;
+            result.reset();
+        }
+        return result;
+    }
+
+    for (auto prefix : pack_search_prefixes) {
+        std::string candidate{prefix};
+        candidate += Resource_pack::default_filename;
+        result.reset(new Resource_pack(candidate));
+        if (!result->empty()) {
+            info() << "Using resource pack " << candidate;
+            return result;
+        }
+    }
+
+    result.reset();
+    return result;
+}
+
+const Resource_pack* Resource_pack::get()
+{
+    static std::unique_ptr<Resource_pack> instance = open_default_pack();
+    return instance.get();
+}
+
+Resource_pack::Resource_pack(const std::string& path)
+{
+#if GE211_PACK_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+
+    struct stat status;
+    if (::fstat(fd, &status) == 0 && status.st_size > 0) {
+        void* addr = ::mmap(nullptr, size_t(status.st_size), PROT_READ,
+                            MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            base_ = static_cast<const unsigned char*>(addr);
+            size_ = size_t(status.st_size);
+            mapped_ = true;
+        }
+    }
+
+    ::close(fd);
+#endif
+
+    // Without mmap, read the whole pack instead.
+    if (!mapped_) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return;
+        fallback_.assign(std::istreambuf_iterator<char>(in),
+                         std::istreambuf_iterator<char>());
+        base_ = fallback_.data();
+        size_ = fallback_.size();
+    }
+
+    if (size_ >= header_size) {
+        count_ = read_u32(base_ + 12);
+        if (!validate_()) count_ = 0;
+    }
+
+    if (empty()) unmap_();
+}
+
+Resource_pack::~Resource_pack()
+{
+    unmap_();
+}
+
+void Resource_pack::unmap_() noexcept
+{
+#if GE211_PACK_MMAP
+    if (mapped_) ::munmap(const_cast<unsigned char*>(base_), size_);
+#endif
+
+    mapped_ = false;
+    fallback_.clear();
+    base_ = nullptr;
+    size_ = 0;
+}
+
+Resource_pack::Entry_ Resource_pack::entry_(size_t index) const noexcept
+{
+    const unsigned char* p = base_ + header_size + index * entry_size;
+    return {read_u64(p), read_u64(p + 8), read_u32(p + 16), read_u32(p + 20)};
+}
+
+// Checks every offset once, so find() can trust them.
+bool Resource_pack::validate_() const noexcept
+{
+    if (std::memcmp(base_, magic, sizeof magic) != 0) return false;
+    if (read_u32(base_ + 8) != version) return false;
+    if (count_ > (size_ - header_size) / entry_size) return false;
+
+    for (size_t i = 0; i < count_; ++i) {
+        Entry_ entry = entry_(i);
+        if (entry.name_offset > size_ ||
+            entry.name_size > size_ - entry.name_offset ||
+            entry.data_offset > size_ ||
+            entry.data_size > size_ - entry.data_offset)
+            return false;
+    }
+
+    return true;
+}
+
+bool Resource_pack::find(const std::string& name,
+                         const unsigned char*& data,
+                         size_t& size) const noexcept
+{
+    // Binary search over the sorted directory, comparing names in place.
+    size_t low = 0, high = count_;
+
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        Entry_ entry = entry_(mid);
+
+        size_t common = std::min(size_t(entry.name_size), name.size());
+        int order = std::memcmp(base_ + entry.name_offset,
+                                name.data(), common);
+        if (order == 0)
+            order = entry.name_size < name.size() ? -1 :
+                    entry.name_size > name.size() ? 1 : 0;
+
+        if (order < 0) {
+            low = mid + 1;
+        } else if (order > 0) {
+            high = mid;
+        } else {
+            data = base_ + entry.data_offset;
+            size = size_t(entry.data_size);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<std::string> Resource_pack::names() const
+{
+    std::vector<std::string> result;
+
+    for (size_t i = 0; i < count_; ++i) {
+        Entry_ entry = entry_(i);
+        result.emplace_back(
+                reinterpret_cast<const char*>(base_ + entry.name_offset),
+                entry.name_size);
+    }
+
+    return result;
+}
+
+} // end namespace detail
+
+}
@@ -0,0 +1,266 @@
+#include "ge211_recorder.h"
+#include "ge211_error.h"
+#include "ge211_render.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <sstream>
+
+namespace ge211 {
+
+namespace detail {
+
+static const char* const path_variable = "GE211_RECORD";
+static const char* const buffers_variable = "GE211_RECORD_BUFFERS";
+
+static const int default_buffer_count = 8;
+
+// Video frames can't be written out of order, so a video gets one
+// encoder; PNG files can be.
+static const unsigned png_worker_count = 2;
+
+bool Recorder::requested() noexcept
+{
+    const char* path = std::getenv(path_variable);
+    return path != nullptr && *path != '\0';
+}
+
+static int read_buffer_count()
+{
+    const char* value = std::getenv(buffers_variable);
+    if (value == nullptr || *value == '\0') return default_buffer_count;
+
+    char* end;
+    long count = std::strtol(value, &end, 10);
+
+    if (*end != '\0' || count <= 0 || count > 1000) {
+        throw Client_logic_error{std::string{buffers_variable} +
+                                 ": expected a positive number of buffers, "
+                                 "got “" + value + "”"};
+    }
+
+    return int(count);
+}
+
+static bool ends_with(const std::string& s, const std::string& suffix)
+{
+    return s.size() >= suffix.size() &&
+           s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+Recorder::Recorder(Dimensions dimensions, double frame_rate)
+        : path_{std::getenv(path_variable)}
+        , video_{ends_with(path_, ".y4m")}
+        , dimensions_{dimensions}
+{
+    int buffer_count = read_buffer_count();
+
+    if (video_) {
+        video_out_.open(path_, std::ios::binary);
+        if (!video_out_) {
+            throw Client_logic_error{std::string{path_variable} +
+                                     ": could not create “" + path_ + "”"};
+        }
+
+        // Uncapped games still need a nominal rate.
+        int rate = frame_rate > 0 ? int(std::lround(frame_rate)) : 60;
+
+        // 4:2:0 with chroma sited as in JPEG, which is what the encoder
+        // below produces.
+        video_out_ << "YUV4MPEG2 W" << dimensions_.width
+                   << " H" << dimensions_.height
+                   << " F" << rate << ":1 Ip A1:1 C420jpeg\n";
+    }
+
+    for (int i = 0; i < buffer_count; ++i) {
+        frames_.push_back(std::make_unique<Frame_>());
+        Rgba_image& image = frames_.back()->image;
+        image.dimensions = dimensions_;
+        image.pixels.resize(4 * size_t(dimensions_.width) * dimensions_.height);
+    }
+
+    free_.reserve(frames_.size());
+    ready_.reserve(frames_.size());
+    for (auto& frame : frames_)
+        free_.push_back(frame.get());
+
+    unsigned worker_count = video_ ? 1 : png_worker_count;
+    for (unsigned i = 0; i < worker_count; ++i)
+        workers_.emplace_back([this] { work_(); });
+}
+
+Recorder::~Recorder()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+
+    frame_ready_.notify_all();
+
+    for (std::thread& worker : workers_)
+        worker.join();
+
+    info() << "Recorded " << captured_ << " frames to " << path_
+           << " (" << dropped_ << " dropped)";
+}
+
+void Recorder::capture(const Renderer& renderer) noexcept
+{
+    Frame_* frame = nullptr;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++frame_number_;
+
+        if (free_.empty()) {
+            ++dropped_;
+            return;
+        }
+
+        frame = free_.back();
+        free_.pop_back();
+    }
+
+    frame->number = frame_number_;
+
+    // A video can't change size partway through, but PNG files can.
+    bool ok = renderer.read_pixels(frame->image) &&
+              (!video_ || frame->image.dimensions == dimensions_);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        if (ok) {
+            ready_.push_back(frame);
+            ++captured_;
+        } else {
+            free_.push_back(frame);
+            ++dropped_;
+        }
+    }
+
+    if (ok) frame_ready_.notify_one();
+}
+
+unsigned long Recorder::captured() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return captured_;
+}
+
+unsigned long Recorder::dropped() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return dropped_;
+}
+
+// Encodes frames until the recorder is stopping and there are none left.
+void Recorder::work_()
+{
+    // The YUV planes of one video frame, reused for every frame.
+    std::vector<uint8_t> planes;
+
+    std::unique_lock<std::mutex> lock(mutex_);
+
+    for (;;) {
+        frame_ready_.wait(lock, [this] {
+            return stopping_ || !ready_.empty();
+        });
+
+        if (ready_.empty()) return;
+
+        // Oldest first, so a video stays in order.
+        Frame_* frame = ready_.front();
+        ready_.erase(ready_.begin());
+
+        lock.unlock();
+        if (video_) encode_y4m_(*frame, planes);
+        else encode_png_(*frame);
+        lock.lock();
+
+        free_.push_back(frame);
+    }
+}
+
+void Recorder::encode_png_(const Frame_& frame)
+{
+    std::ostringstream filename;
+    filename << path_ << std::setw(6) << std::setfill('0') << frame.number
+             << ".png";
+
+    try {
+        frame.image.save_png(filename.str());
+    } catch (const Host_error& e) {
+        warn() << e.what();
+    }
+}
+
+// Converts RGBA to full-range BT.601 YUV 4:2:0, averaging each 2-by-2
+// block of pixels for the chroma.
+void Recorder::encode_y4m_(const Frame_& frame, std::vector<uint8_t>& planes)
+{
+    int width = frame.image.dimensions.width;
+    int height = frame.image.dimensions.height;
+    int chroma_width = (width + 1) / 2;
+    int chroma_height = (height + 1) / 2;
+
+    size_t luma_size = size_t(width) * height;
+    size_t chroma_size = size_t(chroma_width) * chroma_height;
+    planes.resize(luma_size + 2 * chroma_size);
+
+    uint8_t* y_plane = planes.data();
+    uint8_t* u_plane = y_plane + luma_size;
+    uint8_t* v_plane = u_plane + chroma_size;
+
+    const uint8_t* rgba = frame.image.pixels.data();
+
+    auto clamp = [](double value) {
+        return uint8_t(std::min(255.0, std::max(0.0, value + 0.5)));
+    };
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const uint8_t* p = rgba + 4 * (size_t(y) * width + x);
+            y_plane[size_t(y) * width + x] =
+                    clamp(0.299 * p[0] + 0.587 * p[1] + 0.114 * p[2]);
+        }
+    }
+
+    for (int cy = 0; cy < chroma_height; ++cy) {
+        for (int cx = 0; cx < chroma_width; ++cx) {
+            double r = 0, g = 0, b = 0;
+            int count = 0;
+
+            for (int y = 2 * cy; y < std::min(2 * cy + 2, height); ++y) {
+                for (int x = 2 * cx; x < std::min(2 * cx + 2, width); ++x) {
+                    const uint8_t* p = rgba + 4 * (size_t(y) * width + x);
+                    r += p[0];
+                    g += p[1];
+                    b += p[2];
+                    ++count;
+                }
+            }
+
+            r /= count;
+            g /= count;
+            b /= count;
+
+            size_t at = size_t(cy) * chroma_width + cx;
+            u_plane[at] = clamp(128 - 0.168736 * r - 0.331264 * g + 0.5 * b);
+            v_plane[at] = clamp(128 + 0.5 * r - 0.418688 * g - 0.081312 * b);
+        }
+    }
+
+    video_out_ << "FRAME\n";
+    video_out_.write(reinterpret_cast<const char*>(planes.data()),
+                     std::streamsize(planes.size()));
+
+    if (!video_out_) warn() << "Could not write frame to " << path_;
+}
+
+} // end namespace detail
+
+}
@@ -1,9 +1,12 @@
 #include "ge211_render.h"
+#include "ge211_benchmark.h"
 #include "ge211_error.h"
+#include "ge211_offscreen.h"
 #include "ge211_util.h"
 
 #include <SDL.h>
 
+#include <new>
 #include <utility>
 
 static inline SDL_RendererFlip&
@@ -24,6 +27,12 @@ static const uint32_t renderer_flags_to_try[] = {
         0,
 };
 
+// Benchmarks measure the same renderer everywhere, with nothing waiting
+// for the display.
+static const uint32_t benchmark_renderer_flags_to_try[] = {
+        SDL_RENDERER_SOFTWARE,
+};
+
 SDL_Renderer* Renderer::create_renderer_(SDL_Window* window)
 {
     SDL_Renderer* result;
@@ -32,7 +41,14 @@ SDL_Renderer* Renderer::create_renderer_(SDL_Window* window)
     SDL_SetHint(SDL_HINT_RENDER_DRIVER, "metal");
 #endif
 
-    for (auto flags : renderer_flags_to_try) {
+    bool benchmark = Benchmark::requested();
+    auto flags_begin = benchmark ? std::begin(benchmark_renderer_flags_to_try)
+                                 : std::begin(renderer_flags_to_try);
+    auto flags_end = benchmark ? std::end(benchmark_renderer_flags_to_try)
+                               : std::end(renderer_flags_to_try);
+
+    for (auto flag_ptr = flags_begin; flag_ptr != flags_end; ++flag_ptr) {
+        uint32_t flags = *flag_ptr;
         result = SDL_CreateRenderer(window, -1, flags);
         if (result) {
             SDL_SetRenderDrawBlendMode(result, SDL_BLENDMODE_BLEND);
@@ -47,11 +63,83 @@ SDL_Renderer* Renderer::create_renderer_(SDL_Window* window)
     throw Host_error{"Could not initialize renderer"};
 }
 
+SDL_Renderer* Renderer::create_offscreen_renderer_(SDL_Surface* framebuffer)
+{
+    SDL_Renderer* result = SDL_CreateSoftwareRenderer(framebuffer);
+    if (!result)
+        throw Host_error{"Could not initialize offscreen renderer"};
+
+    SDL_SetRenderDrawBlendMode(result, SDL_BLENDMODE_BLEND);
+    return result;
+}
+
+const Blend_equation premultiplied_blend{
+        SDL_BLENDFACTOR_ONE,
+        SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+        SDL_BLENDOPERATION_ADD,
+};
+
+Color premultiplied_tint(Color color) noexcept
+{
+    int alpha = color.alpha();
+    return Color{uint8_t(color.red() * alpha / 255),
+                 uint8_t(color.green() * alpha / 255),
+                 uint8_t(color.blue() * alpha / 255),
+                 color.alpha()};
+}
+
+static SDL_BlendMode premultiplied_blend_mode()
+{
+    const Blend_equation& e = premultiplied_blend;
+    return SDL_ComposeCustomBlendMode(e.source, e.destination, e.operation,
+                                      e.source, e.destination, e.operation);
+}
+
+bool Renderer::check_targets_(SDL_Renderer* raw) noexcept
+{
+    if (SDL_RenderTargetSupported(raw) != SDL_TRUE) return false;
+
+    // Renderers that don't support a blend mode refuse to draw with it.
+    bool result =
+            SDL_SetRenderDrawBlendMode(raw, premultiplied_blend_mode()) == 0;
+    SDL_SetRenderDrawBlendMode(raw, SDL_BLENDMODE_BLEND);
+
+    if (!result)
+        debug() << "Renderer can't blend premultiplied alpha; "
+                   "Layer_sprites will draw their sprites one by one";
+
+    return result;
+}
+
+SDL_Surface* Renderer::create_framebuffer_(Dimensions dims)
+{
+    SDL_Surface* result = SDL_CreateRGBSurfaceWithFormat(
+            0, dims.width, dims.height, 32, SDL_PIXELFORMAT_RGBA32);
+    if (!result)
+        throw Host_error{"Could not allocate offscreen framebuffer"};
+
+    return result;
+}
+
 Renderer::Renderer(const Window& window)
-        : ptr_{create_renderer_(window.get_raw_()),
+        : framebuffer_{nullptr, &SDL_FreeSurface}
+        , ptr_{create_renderer_(window.get_raw_()),
                &SDL_DestroyRenderer}
+        , supports_targets_{check_targets_(ptr_.get())}
 { }
 
+Renderer::Renderer(Dimensions dims)
+        : framebuffer_{create_framebuffer_(dims), &SDL_FreeSurface}
+        , ptr_{create_offscreen_renderer_(framebuffer_.get()),
+               &SDL_DestroyRenderer}
+        , supports_targets_{check_targets_(ptr_.get())}
+{ }
+
+const SDL_Surface* Renderer::get_framebuffer() const noexcept
+{
+    return framebuffer_.get();
+}
+
 bool Renderer::is_vsync() const noexcept
 {
     SDL_RendererInfo info;
@@ -83,15 +171,43 @@ void Renderer::present() noexcept
     SDL_RenderPresent(get_raw_());
 }
 
+Dimensions Renderer::output_dimensions() const noexcept
+{
+    Dimensions result{0, 0};
+    SDL_GetRendererOutputSize(get_raw_(), &result.width, &result.height);
+    return result;
+}
+
+bool Renderer::read_pixels(Rgba_image& image) const noexcept
+{
+    Dimensions dims = output_dimensions();
+    size_t size = 4 * size_t(dims.width) * dims.height;
+
+    // Only allocates if the output has grown.
+    try {
+        image.pixels.resize(size);
+    } catch (const std::bad_alloc&) {
+        return false;
+    }
+    image.dimensions = dims;
+
+    return SDL_RenderReadPixels(get_raw_(), nullptr, SDL_PIXELFORMAT_RGBA32,
+                                image.pixels.data(), 4 * dims.width) == 0;
+}
+
 void Renderer::copy(const Texture& texture, Position xy)
 {
     auto raw_texture = texture.get_raw_(*this);
     if (!raw_texture) return;
 
+    texture.modulate_(raw_texture, Color::white());
+
     SDL_Rect dstrect = Rectangle::from_top_left(xy, texture.dimensions());
+    SDL_Rect srcbuf;
 
     int render_result = SDL_RenderCopy(get_raw_(), raw_texture,
-                                       nullptr, &dstrect);
+                                       texture.get_region_(srcbuf),
+                                       &dstrect);
     if (render_result < 0) {
         warn_sdl() << "Could not render texture";
     }
@@ -104,16 +220,32 @@ void Renderer::copy(const Texture& texture,
     auto raw_texture = texture.get_raw_(*this);
     if (!raw_texture) return;
 
+    texture.modulate_(raw_texture, transform.get_tint());
+
+    // A tint alone doesn't need the slower copy.
+    if (transform.is_untransformed()) {
+        SDL_Rect dstrect = Rectangle::from_top_left(xy, texture.dimensions());
+        SDL_Rect srcbuf;
+
+        if (SDL_RenderCopy(get_raw_(), raw_texture,
+                           texture.get_region_(srcbuf), &dstrect) < 0) {
+            warn_sdl() << "Could not render texture";
+        }
+        return;
+    }
+
     SDL_Rect dstrect = Rectangle::from_top_left(xy, texture.dimensions());
     dstrect.w = int(dstrect.w * transform.get_scale_x());
     dstrect.h = int(dstrect.h * transform.get_scale_y());
+    SDL_Rect srcbuf;
 
     SDL_RendererFlip flip = SDL_FLIP_NONE;
     if (transform.get_flip_h()) flip |= SDL_FLIP_HORIZONTAL;
     if (transform.get_flip_v()) flip |= SDL_FLIP_VERTICAL;
 
     int render_result = SDL_RenderCopyEx(get_raw_(), raw_texture,
-                                         nullptr, &dstrect,
+                                         texture.get_region_(srcbuf),
+                                         &dstrect,
                                          transform.get_rotation(),
                                          nullptr,
                                          flip);
@@ -127,6 +259,80 @@ void Renderer::prepare(const Texture& texture) const
     texture.get_raw_(*this);
 }
 
+Texture Renderer::create_streaming_texture(Dimensions dims) const
+{
+    SDL_Texture* raw = SDL_CreateTexture(get_raw_(),
+                                         SDL_PIXELFORMAT_ARGB8888,
+                                         SDL_TEXTUREACCESS_STREAMING,
+                                         dims.width,
+                                         dims.height);
+    if (!raw)
+        throw Host_error{"Could not create streaming texture"};
+
+    SDL_SetTextureBlendMode(raw, SDL_BLENDMODE_BLEND);
+
+    Texture result;
+    result.impl_ = std::make_shared<Texture::Impl_>(raw);
+    return result;
+}
+
+bool Renderer::supports_targets() const noexcept
+{
+    return supports_targets_;
+}
+
+Texture Renderer::create_target_texture(Dimensions dims) const
+{
+    SDL_Texture* raw = SDL_CreateTexture(get_raw_(),
+                                         SDL_PIXELFORMAT_RGBA32,
+                                         SDL_TEXTUREACCESS_TARGET,
+                                         dims.width,
+                                         dims.height);
+    if (!raw)
+        throw Host_error{"Could not create target texture"};
+
+    SDL_SetTextureBlendMode(raw, premultiplied_blend_mode());
+
+    Texture result;
+    result.impl_ = std::make_shared<Texture::Impl_>(raw);
+    result.impl_->premultiplied_ = true;
+    return result;
+}
+
+Renderer::Target_scope::Target_scope(Renderer& renderer,
+                                     const Texture& texture)
+        : renderer_{renderer}
+        , previous_target_{SDL_GetRenderTarget(renderer.get_raw_())}
+{
+    Uint8 r, g, b, a;
+    SDL_GetRenderDrawColor(renderer.get_raw_(), &r, &g, &b, &a);
+    previous_color_ = Color{r, g, b, a};
+
+    if (SDL_SetRenderTarget(renderer.get_raw_(),
+                            texture.get_raw_(renderer)) < 0)
+        throw Host_error{"Could not set render target"};
+}
+
+Renderer::Target_scope::~Target_scope()
+{
+    if (SDL_SetRenderTarget(renderer_.get_raw_(), previous_target_) < 0)
+        warn_sdl() << "Could not restore render target";
+
+    SDL_SetRenderDrawColor(renderer_.get_raw_(),
+                           previous_color_.red(), previous_color_.green(),
+                           previous_color_.blue(), previous_color_.alpha());
+}
+
+unsigned long Renderer::target_generation() const noexcept
+{
+    return target_generation_;
+}
+
+void Renderer::invalidate_targets() noexcept
+{
+    ++target_generation_;
+}
+
 Texture::Impl_::Impl_(SDL_Surface* surface) noexcept
         : Impl_{{surface, &SDL_FreeSurface}}
 { }
@@ -138,12 +344,24 @@ Texture::Impl_::Impl_(SDL_Texture* texture) noexcept
 Texture::Impl_::Impl_(delete_ptr<SDL_Surface> surface) noexcept
         : surface_{std::move(surface)},
           texture_{nullptr, &no_op_deleter}
-{ }
+{
+    if (surface_) {
+        dimensions_ = {surface_->w, surface_->h};
+        format_ = surface_->format->format;
+    }
+}
 
 Texture::Impl_::Impl_(delete_ptr<SDL_Texture> texture) noexcept
         : surface_{nullptr, &no_op_deleter},
           texture_{std::move(texture)}
-{ }
+{
+    if (texture_) {
+        int access = 0;
+        SDL_QueryTexture(texture_.get(), &format_, &access,
+                         &dimensions_.width, &dimensions_.height);
+        streaming_ = access == SDL_TEXTUREACCESS_STREAMING;
+    }
+}
 
 Texture::Texture() noexcept
         : impl_{nullptr}
@@ -157,6 +375,12 @@ Texture::Texture(delete_ptr<SDL_Surface> surface)
         : impl_{std::make_shared<Impl_>(std::move(surface))}
 { }
 
+Texture::Texture(const Texture& atlas, Rectangle region) noexcept
+        : impl_{atlas.impl_},
+          region_{region},
+          is_region_{true}
+{ }
+
 SDL_Texture* Texture::get_raw_(const Renderer& renderer) const
 {
     if (impl_->texture_) return impl_->texture_.get();
@@ -173,23 +397,45 @@ SDL_Texture* Texture::get_raw_(const Renderer& renderer) const
     throw Host_error{"Could not create texture from surface"};
 }
 
+void Texture::modulate_(SDL_Texture* raw, Color color) const noexcept
+{
+    if (impl_->modulation_ == color) return;
+
+    Color mod = impl_->premultiplied_ ? premultiplied_tint(color) : color;
+    SDL_SetTextureColorMod(raw, mod.red(), mod.green(), mod.blue());
+
+    SDL_SetTextureAlphaMod(raw, color.alpha());
+    impl_->modulation_ = color;
+}
+
+SDL_Rect const* Texture::get_region_(SDL_Rect& buffer) const noexcept
+{
+    if (!is_region_) return nullptr;
+
+    buffer = region_;
+    return &buffer;
+}
+
 Dimensions Texture::dimensions() const noexcept
 {
-    Dimensions result{0, 0};
+    if (is_region_) return region_.dimensions();
+    return impl_->dimensions_;
+}
 
-    if (impl_->texture_) {
-        SDL_QueryTexture(impl_->texture_.get(), nullptr, nullptr,
-                         &result.width, &result.height);
-    } else if (impl_->surface_) {
-        result.width = impl_->surface_->w;
-        result.height = impl_->surface_->h;
-    }
+uint32_t Texture::format() const noexcept
+{
+    return impl_->format_;
+}
 
-    return result;
+bool Texture::is_streaming() const noexcept
+{
+    return impl_->streaming_;
 }
 
 SDL_Surface* Texture::as_surface() noexcept
 {
+    if (is_region_) return nullptr;
+
     return impl_->surface_.get();
 }
 
@@ -198,6 +444,31 @@ bool Texture::empty() const noexcept
     return impl_ == nullptr;
 }
 
+bool Texture::is_region() const noexcept
+{
+    return is_region_;
+}
+
+uint32_t* Texture::lock(Rectangle region, int& pitch) noexcept
+{
+    if (!impl_ || !impl_->streaming_) return nullptr;
+
+    SDL_Rect rect = region;
+    void* pixels;
+
+    if (SDL_LockTexture(impl_->texture_.get(), &rect, &pixels, &pitch) < 0) {
+        warn_sdl() << "Could not lock texture";
+        return nullptr;
+    }
+
+    return static_cast<uint32_t*>(pixels);
+}
+
+void Texture::unlock() noexcept
+{
+    SDL_UnlockTexture(impl_->texture_.get());
+}
+
 } // end namespace detail
 
 }
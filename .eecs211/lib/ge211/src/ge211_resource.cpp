@@ -1,10 +1,14 @@
 #include "ge211_resource.h"
 #include "ge211_error.h"
+#include "ge211_pack.h"
 
 #include <SDL.h>
 #include <SDL_ttf.h>
 
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 namespace ge211 {
 
@@ -30,16 +34,99 @@ static void close_rwops(SDL_RWops* rwops)
     SDL_RWclose(rwops);
 }
 
-delete_ptr<SDL_RWops> File_resource::open_rwops_(const std::string& filename)
+std::mutex& ttf_mutex()
+{
+    static std::mutex mutex;
+    return mutex;
+}
+
+static void close_font(TTF_Font* font)
+{
+    std::lock_guard<std::mutex> lock(ttf_mutex());
+    TTF_CloseFont(font);
+}
+
+// Finds the file in the resource pack, if there is one.
+static bool find_in_pack(const std::string& filename,
+                         const unsigned char*& data,
+                         size_t& size)
+{
+    const Resource_pack* pack = Resource_pack::get();
+    return pack && pack->find(filename, data, size);
+}
+
+std::string File_resource::search_path_(const std::string& filename)
 {
     for (auto prefix : search_prefixes) {
         std::string path;
         path += prefix;
         path += filename;
         SDL_RWops* rwops = SDL_RWFromFile(path.c_str(), "rb");
+        if (rwops) {
+            close_rwops(rwops);
+            return path;
+        }
+    }
+
+    throw File_error::could_not_open(filename);
+}
+
+std::string File_resource::resolve_path(const std::string& filename)
+{
+    static std::mutex mutex;
+    static std::unordered_map<std::string, std::string> index;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto found = index.find(filename);
+        if (found != index.end()) return found->second;
+    }
+
+    std::string path = search_path_(filename);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    return index.emplace(filename, std::move(path)).first->second;
+}
+
+static std::shared_ptr<const Resource_bytes>
+read_resource_bytes(const std::string& filename)
+{
+    File_resource file(filename);
+    SDL_RWops* rwops = file.get_raw();
+
+    auto result = std::make_shared<Resource_bytes>();
+    Sint64 size = SDL_RWsize(rwops);
+    if (size > 0) result->reserve(size_t(size));
+
+    unsigned char buffer[4096];
+    size_t count;
+    while ((count = SDL_RWread(rwops, buffer, 1, sizeof buffer)) > 0)
+        result->insert(result->end(), buffer, buffer + count);
+
+    return result;
+}
+
+std::shared_ptr<const Resource_bytes>
+load_resource_bytes(const std::string& filename)
+{
+    static Asset_cache<std::string, const Resource_bytes> cache;
+    return cache.get(filename, [&] { return read_resource_bytes(filename); });
+}
+
+delete_ptr<SDL_RWops> File_resource::open_rwops_(const std::string& filename)
+{
+    // Packed files are read in place from the mapped pack.
+    const unsigned char* data;
+    size_t size;
+    if (find_in_pack(filename, data, size)) {
+        SDL_RWops* rwops = SDL_RWFromConstMem(data, int(size));
         if (rwops) return {rwops, &close_rwops};
     }
 
+    std::string path = resolve_path(filename);
+    SDL_RWops* rwops = SDL_RWFromFile(path.c_str(), "rb");
+    if (rwops) return {rwops, &close_rwops};
+
     throw File_error::could_not_open(filename);
 }
 
@@ -47,23 +134,45 @@ File_resource::File_resource(const std::string& filename)
         : ptr_{open_rwops_(filename)}
 { }
 
+File_resource::File_resource(const Resource_bytes& bytes,
+                             const std::string& filename)
+        : ptr_{SDL_RWFromConstMem(bytes.data(), int(bytes.size())),
+               &close_rwops}
+{
+    if (!ptr_) throw File_error::could_not_open(filename);
+}
+
 } // end namespace detail
 
-delete_ptr<TTF_Font> Font::load_(const std::string& filename,
-                                 File_resource&& file,
-                                 int size)
+std::shared_ptr<TTF_Font> Font::load_(const std::string& filename, int size)
 {
+    // A packed file stays mapped for good, so it can be read in place.
+    const unsigned char* data;
+    size_t data_size;
+    if (find_in_pack(filename, data, data_size)) {
+        File_resource file(filename);
+        std::lock_guard<std::mutex> lock(ttf_mutex());
+        TTF_Font* result = TTF_OpenFontRW(std::move(file).release(), 1, size);
+        if (!result) throw Font_error::could_not_load(filename);
+        return {result, &close_font};
+    }
+
+    // SDL_ttf reads from the file for as long as the font is open, so
+    // the font keeps the bytes alive and fonts of every size share them.
+    auto bytes = load_resource_bytes(filename);
+    File_resource file(*bytes, filename);
+
+    std::lock_guard<std::mutex> lock(ttf_mutex());
     TTF_Font* result = TTF_OpenFontRW(std::move(file).release(), 1, size);
-    if (result) return {result, &TTF_CloseFont};
+    if (!result) throw Font_error::could_not_load(filename);
 
-    throw Font_error::could_not_load(filename);
+    return {result, [bytes](TTF_Font* font) { close_font(font); }};
 }
 
 Font::Font(const std::string& filename, int size)
-        : ptr_{nullptr, &no_op_deleter}
 {
-    File_resource fr(filename);
-    ptr_ = load_(filename, std::move(fr), size);
+    static Asset_cache<std::pair<std::string, int>, TTF_Font> cache;
+    ptr_ = cache.get({filename, size}, [&] { return load_(filename, size); });
 }
 
 }
\ No newline at end of file
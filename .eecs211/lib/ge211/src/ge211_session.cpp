@@ -1,5 +1,7 @@
 #include "ge211_session.h"
+#include "ge211_benchmark.h"
 #include "ge211_error.h"
+#include "ge211_pack.h"
 #include "ge211_util.h"
 
 #include <SDL.h>
@@ -13,42 +15,80 @@ namespace ge211 {
 
 namespace detail {
 
-Session::Session()
+// SDL_Quit shuts down everything at once, so only the last session to go
+// calls it.
+static int live_sessions = 0;
+
+Session::Session(Mode mode)
+        : mode_{mode}
 {
-    setlocale(LC_ALL, "en_US.utf8");
+    if (live_sessions++ == 0) {
+        setlocale(LC_ALL, "en_US.utf8");
 
-    int mix_flags = MIX_INIT_OGG | MIX_INIT_MP3;
-    if ((Mix_Init(mix_flags) & mix_flags) != mix_flags) {
-        info_sdl() << "Could not pre-initialize audio mixer";
-    }
+        // Benchmarks must run without a display or a sound card.
+        if (Benchmark::requested()) {
+            SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+            SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+            SDL_SetHint(SDL_HINT_RENDER_VSYNC, "0");
+        }
 
-    if (SDL_Init(SDL_INIT_VIDEO) < 0) {
-        fatal_sdl() << "Could not initialize graphics";
-        exit(1);
-    }
+        int mix_flags = MIX_INIT_OGG | MIX_INIT_MP3;
+        if ((Mix_Init(mix_flags) & mix_flags) != mix_flags) {
+            info_sdl() << "Could not pre-initialize audio mixer";
+        }
+
+        if (SDL_Init(0) < 0) {
+            fatal_sdl() << "Could not initialize SDL";
+            exit(1);
+        }
+
+        int img_flags = IMG_INIT_JPG | IMG_INIT_PNG;
+        if (IMG_Init(img_flags) != img_flags) {
+            fatal_sdl() << "Could not initialize image loading support";
+            exit(1);
+        }
+
+        if (TTF_Init() < 0) {
+            fatal_sdl() << "Could not initialize text handling";
+            exit(1);
+        }
 
-    int img_flags = IMG_INIT_JPG | IMG_INIT_PNG;
-    if (IMG_Init(img_flags) != img_flags) {
-        fatal_sdl() << "Could not initialize image loading support";
-        exit(1);
+        // Maps the resource pack, if any, now rather than on the first load.
+        Resource_pack::get();
     }
 
-    if (TTF_Init() < 0) {
-        fatal_sdl() << "Could not initialize text handling";
-        exit(1);
+    if (mode_ == Mode::windowed) {
+        if (SDL_InitSubSystem(SDL_INIT_VIDEO) < 0) {
+            fatal_sdl() << "Could not initialize graphics";
+            exit(1);
+        }
+
+        SDL_StartTextInput();
     }
+}
 
-    SDL_StartTextInput();
+Session::Session(Session&& other) noexcept
+        : active_{other.active_}
+        , mode_{other.mode_}
+{
+    other.active_ = false;
 }
 
 Session::~Session()
 {
-    SDL_StopTextInput();
+    if (!active_) return;
 
-    TTF_Quit();
-    IMG_Quit();
-    SDL_Quit();
-    Mix_Quit();
+    if (mode_ == Mode::windowed) {
+        SDL_StopTextInput();
+        SDL_QuitSubSystem(SDL_INIT_VIDEO);
+    }
+
+    if (--live_sessions == 0) {
+        TTF_Quit();
+        IMG_Quit();
+        SDL_Quit();
+        Mix_Quit();
+    }
 }
 
 } // end namespace detail
@@ -5,7 +5,12 @@
 #include <SDL_image.h>
 #include <SDL_ttf.h>
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 namespace ge211 {
 
@@ -26,6 +31,255 @@ Sprite_set& Sprite_set::add_sprite(const Sprite& sprite, Position xy, int z)
     return add_sprite(sprite, xy, z, Transform{});
 }
 
+Sprite_list&
+Sprite_list::add_sprite(const Sprite& sprite, Position xy, int z,
+                        const Transform& t)
+{
+    sprites_.emplace_back(sprite, xy, z, t);
+    return *this;
+}
+
+Sprite_list& Sprite_list::add_sprite(const Sprite& sprite, Position xy, int z)
+{
+    return add_sprite(sprite, xy, z, Transform{});
+}
+
+void Sprite_list::reserve(size_t capacity)
+{
+    sprites_.reserve(capacity);
+}
+
+size_t Sprite_list::size() const noexcept
+{
+    return sprites_.size();
+}
+
+void Sprite_set::reserve(size_t capacity)
+{
+    sprites_.reserve(capacity);
+}
+
+Sprite_set& Sprite_set::add_sprites(Sprite_list& list)
+{
+    sprites_.insert(sprites_.end(), list.sprites_.begin(), list.sprites_.end());
+    list.sprites_.clear();
+    return *this;
+}
+
+Sprite_set& Sprite_set::add_parallel(size_t count, unsigned thread_count,
+                                     const Build_function& build)
+{
+    if (thread_count == 0)
+        throw Client_logic_error{"Sprite_set::add_parallel: no threads"};
+
+    // Every thread should have something to do.
+    thread_count = unsigned(std::min<size_t>(thread_count,
+                                             std::max<size_t>(count, 1)));
+
+    if (lists_.size() < thread_count) lists_.resize(thread_count);
+
+    std::vector<std::exception_ptr> errors(thread_count);
+
+    auto build_range = [&](unsigned i) {
+        try {
+            build(lists_[i], count * i / thread_count,
+                  count * (i + 1) / thread_count);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(thread_count - 1);
+    for (unsigned i = 1; i < thread_count; ++i)
+        threads.emplace_back(build_range, i);
+
+    build_range(0);
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            for (unsigned i = 0; i < thread_count; ++i)
+                lists_[i].sprites_.clear();
+            std::rethrow_exception(error);
+        }
+    }
+
+    size_t total = sprites_.size();
+    for (unsigned i = 0; i < thread_count; ++i)
+        total += lists_[i].size();
+    sprites_.reserve(total);
+
+    // In order of the ranges, whichever thread finished first.
+    for (unsigned i = 0; i < thread_count; ++i)
+        add_sprites(lists_[i]);
+
+    return *this;
+}
+
+static bool retained_z_less(const std::shared_ptr<Retained_sprite>& a,
+                            const std::shared_ptr<Retained_sprite>& b)
+{
+    return a->placed.z < b->placed.z;
+}
+
+Sprite_handle
+Sprite_set::add_retained(const Sprite& sprite, Position xy, int z,
+                         const Transform& t)
+{
+    auto ptr = std::make_shared<Retained_sprite>(
+            Placed_sprite{sprite, xy, z, t});
+
+    // Inserting after every sprite with the same z keeps retained_ sorted
+    // stably, without waiting for update_retained_().
+    auto where = std::upper_bound(retained_.begin(), retained_.end(),
+                                  ptr, retained_z_less);
+    retained_.insert(where, ptr);
+
+    return Sprite_handle{std::move(ptr)};
+}
+
+void Sprite_set::update_retained_()
+{
+    bool resort = false;
+
+    for (auto& ptr : retained_) {
+        // An entry nobody else refers to can never be updated again.
+        if (ptr.use_count() == 1) ptr->removed = true;
+        resort |= ptr->z_changed;
+        ptr->z_changed = false;
+    }
+
+    auto end = std::remove_if(retained_.begin(), retained_.end(),
+                              [](const auto& ptr) { return ptr->removed; });
+    retained_.erase(end, retained_.end());
+
+    if (resort)
+        std::stable_sort(retained_.begin(), retained_.end(), retained_z_less);
+}
+
+void Sprite_set::paint_(Renderer& renderer)
+{
+    update_retained_();
+
+    sort_by_z(sprites_, sort_buffer_);
+
+    // Retained sprites are already in z order, so we merge them with the
+    // one-frame sprites.
+    auto retained = retained_.begin();
+    auto retained_end = retained_.end();
+
+    auto render_retained_up_to = [&](auto is_before) {
+        for ( ; retained != retained_end && is_before(**retained); ++retained)
+            if ((*retained)->visible) (*retained)->placed.render(renderer);
+    };
+
+    for (const Placed_sprite& sprite : sprites_) {
+        render_retained_up_to([&](const Retained_sprite& r) {
+            return r.placed.z <= sprite.z;
+        });
+        sprite.render(renderer);
+    }
+
+    render_retained_up_to([](const Retained_sprite&) { return true; });
+
+    sprites_.clear();
+}
+
+Sprite_handle::Sprite_handle() noexcept
+{ }
+
+Sprite_handle::Sprite_handle(std::shared_ptr<Retained_sprite> ptr) noexcept
+        : ptr_{std::move(ptr)}
+{ }
+
+bool Sprite_handle::empty() const noexcept
+{
+    return ptr_ == nullptr || ptr_->removed;
+}
+
+Sprite_handle::operator bool() const noexcept
+{
+    return !empty();
+}
+
+Retained_sprite& Sprite_handle::get_() const
+{
+    if (empty())
+        throw Client_logic_error{"Sprite_handle: handle is empty"};
+
+    return *ptr_;
+}
+
+Sprite_handle& Sprite_handle::set_sprite(const Sprite& sprite)
+{
+    get_().placed.sprite = &sprite;
+    return *this;
+}
+
+Sprite_handle& Sprite_handle::set_position(Position xy)
+{
+    get_().placed.xy = xy;
+    return *this;
+}
+
+Sprite_handle& Sprite_handle::set_z(int z)
+{
+    Retained_sprite& retained = get_();
+
+    if (retained.placed.z != z) {
+        retained.placed.z = z;
+        retained.z_changed = true;
+    }
+
+    return *this;
+}
+
+Sprite_handle& Sprite_handle::set_transform(const Transform& transform)
+{
+    get_().placed.transform = transform;
+    return *this;
+}
+
+Sprite_handle& Sprite_handle::set_visible(bool visible)
+{
+    get_().visible = visible;
+    return *this;
+}
+
+const Sprite& Sprite_handle::get_sprite() const
+{
+    return *get_().placed.sprite;
+}
+
+Position Sprite_handle::get_position() const
+{
+    return get_().placed.xy;
+}
+
+int Sprite_handle::get_z() const
+{
+    return get_().placed.z;
+}
+
+const Transform& Sprite_handle::get_transform() const
+{
+    return get_().placed.transform;
+}
+
+bool Sprite_handle::get_visible() const
+{
+    return get_().visible;
+}
+
+void Sprite_handle::remove() noexcept
+{
+    if (ptr_) ptr_->removed = true;
+    ptr_ = nullptr;
+}
+
 namespace detail {
 
 Placed_sprite::Placed_sprite(const Sprite& sprite, Position xy,
@@ -43,6 +297,55 @@ bool operator<(const Placed_sprite& s1, const Placed_sprite& s2) noexcept
     return s1.z > s2.z;
 }
 
+// The largest span of z values (max z - min z + 1) that sort_by_z handles
+// with a counting sort; beyond this it falls back to std::stable_sort.
+static const int max_bucket_z_range = 64;
+
+void sort_by_z(std::vector<Placed_sprite>& sprites,
+               std::vector<Placed_sprite>& buffer)
+{
+    if (sprites.size() < 2) return;
+
+    auto minmax = std::minmax_element(
+            sprites.begin(), sprites.end(),
+            [](const Placed_sprite& a, const Placed_sprite& b) {
+                return a.z < b.z;
+            });
+    int z_min = minmax.first->z;
+    long z_range = long(minmax.second->z) - z_min + 1;
+
+    if (z_range == 1) return;
+
+    if (z_range > max_bucket_z_range) {
+        std::stable_sort(sprites.begin(), sprites.end(),
+                         [](const Placed_sprite& a, const Placed_sprite& b) {
+                             return a.z < b.z;
+                         });
+        return;
+    }
+
+    // offsets[z - z_min] becomes the index where the next sprite with
+    // that z goes.
+    std::array<size_t, max_bucket_z_range> offsets{};
+    for (const Placed_sprite& sprite : sprites)
+        ++offsets[sprite.z - z_min];
+
+    size_t total = 0;
+    for (long i = 0; i < z_range; ++i) {
+        size_t count = offsets[i];
+        offsets[i] = total;
+        total += count;
+    }
+
+    buffer.assign(sprites.begin(), sprites.end());
+    for (const Placed_sprite& sprite : buffer)
+        sprites[offsets[sprite.z - z_min]++] = sprite;
+}
+
+Retained_sprite::Retained_sprite(const Placed_sprite& placed) noexcept
+        : placed{placed}
+{ }
+
 Dimensions Texture_sprite::dimensions() const
 {
     return get_texture_().dimensions();
@@ -113,6 +416,16 @@ void Render_sprite::set_pixel(Position xy, Color color)
     fill_rectangle({xy.x, xy.y, 1, 1}, color);
 }
 
+void Render_sprite::fill_row(int y, int x_begin, int x_end, Color color)
+{
+    auto surface = as_surface();
+
+    // Surfaces from create_surface_ live in memory and never need locking.
+    uint32_t* row = reinterpret_cast<uint32_t*>(
+            static_cast<char*>(surface->pixels) + size_t(y) * surface->pitch);
+    std::fill(row + x_begin, row + x_end, color.to_sdl_(surface->format));
+}
+
 } // end namespace detail
 
 namespace sprites {
@@ -147,27 +460,80 @@ static Dimensions compute_circle_dimensions(int radius)
     return {radius * 2, radius * 2};
 }
 
-Circle_sprite::Circle_sprite(int radius, Color color)
+// How far row `y` below (or above) the center of a circle extends to
+// each side: the number of pixels x >= 0 with x * x + y * y < radius *
+// radius, which is the smallest half with half * half >= radius * radius
+// - y * y.
+static int circle_half_width(int radius, int y)
+{
+    long limit = long(radius) * radius - long(y) * y;
+    if (limit <= 0) return 0;
+
+    // The square root may be off by one either way for large radii.
+    int half = int(std::sqrt(double(limit)));
+    while (long(half) * half < limit) ++half;
+    while (half > 0 && long(half - 1) * (half - 1) >= limit) --half;
+
+    return half;
+}
+
+Circle_sprite::Circle_sprite(int radius, Color color, Edge edge)
         : Render_sprite{compute_circle_dimensions(radius)}
+        , edge_{edge}
 {
     const int cx = radius;
     const int cy = radius;
 
+    if (edge == Edge::sharp) {
+        for (int y = 0; y < radius; ++y) {
+            int half = circle_half_width(radius, y);
+            fill_row(cy + y, cx - half, cx + half, color);
+            fill_row(cy - y - 1, cx - half, cx + half, color);
+        }
+        return;
+    }
+
+    // Each pixel's coverage is estimated from the distance of its center
+    // to the circle's center: pixels within radius - 1/2 are covered
+    // fully, and coverage falls off linearly to none at radius + 1/2.
+    double outer = radius + 0.5;
+    double inner = radius - 0.5;
+
     for (int y = 0; y < radius; ++y) {
-        for (int x = 0; x < radius; ++x) {
-            if (x * x + y * y < radius * radius) {
-                set_pixel({cx + x, cy + y}, color);
-                set_pixel({cx + x, cy - y - 1}, color);
-                set_pixel({cx - x - 1, cy + y}, color);
-                set_pixel({cx - x - 1, cy - y - 1}, color);
-            }
+        double dy = y + 0.5;
+
+        // The pixels up to `solid` to each side of the center are covered
+        // fully. The center of pixel x is x + 1/2 from the circle's.
+        int solid = 0;
+        if (inner * inner > dy * dy) {
+            solid = int(std::sqrt(inner * inner - dy * dy) + 0.5);
+            solid = std::min(solid, radius);
+        }
+
+        fill_row(cy + y, cx - solid, cx + solid, color);
+        fill_row(cy - y - 1, cx - solid, cx + solid, color);
+
+        for (int x = solid; x < radius; ++x) {
+            double dx = x + 0.5;
+            double coverage = outer - std::sqrt(dx * dx + dy * dy);
+            if (coverage <= 0) break;
+
+            Color edge_color = color;
+            if (coverage < 1)
+                edge_color = Color{color.red(), color.green(), color.blue(),
+                                   uint8_t(color.alpha() * coverage + 0.5)};
+
+            fill_row(cy + y, cx + x, cx + x + 1, edge_color);
+            fill_row(cy + y, cx - x - 1, cx - x, edge_color);
+            fill_row(cy - y - 1, cx + x, cx + x + 1, edge_color);
+            fill_row(cy - y - 1, cx - x - 1, cx - x, edge_color);
         }
     }
 }
 
 void Circle_sprite::recolor(Color color)
 {
-    *this = Circle_sprite{radius_(), color};
+    *this = Circle_sprite{radius_(), color, edge_};
 }
 
 int Circle_sprite::radius_() const
@@ -175,22 +541,25 @@ int Circle_sprite::radius_() const
     return dimensions().width >> 1;
 }
 
-Texture
+std::shared_ptr<const Texture>
 Image_sprite::load_texture_(const std::string& filename)
 {
     File_resource file(filename);
     SDL_Surface* raw = IMG_Load_RW(file.get_raw(), 0);
-    if (raw) return Texture(raw);
+    if (raw) return std::make_shared<const Texture>(raw);
 
     throw Image_error::could_not_load(filename);
 }
 
 Image_sprite::Image_sprite(const std::string& filename)
-        : texture_{load_texture_(filename)} {}
+{
+    static Asset_cache<std::string, const Texture> cache;
+    texture_ = cache.get(filename, [&] { return load_texture_(filename); });
+}
 
 const Texture& Image_sprite::get_texture_() const
 {
-    return texture_;
+    return *texture_;
 }
 
 Texture
@@ -203,6 +572,8 @@ Text_sprite::create_texture(const Builder& config)
     if (message.empty())
         return Texture{};
 
+    std::lock_guard<std::mutex> lock(ttf_mutex());
+
     if (config.word_wrap() > 0) {
         raw = TTF_RenderUTF8_Blended_Wrapped(
                 config.font().get_raw_(),
@@ -339,6 +710,329 @@ void Multiplexed_sprite::render(detail::Renderer& renderer,
     selection.render(renderer, position, transform);
 }
 
+// Space left around each packed sprite so that scaled or rotated copies
+// don't sample their neighbors.
+static int const atlas_padding = 1;
+
+static Dimensions check_atlas_dimensions(Dimensions dims)
+{
+    if (dims.width <= 0 || dims.height <= 0) {
+        throw Client_logic_error(
+                "Sprite_atlas: width and height must both be positive");
+    }
+
+    return dims;
+}
+
+Sprite_atlas::Sprite_atlas(Dimensions dims)
+        : texture_{Render_sprite::create_surface_(
+                check_atlas_dimensions(dims))}
+{ }
+
+Dimensions Sprite_atlas::dimensions() const
+{
+    return texture_.dimensions();
+}
+
+Rectangle Sprite_atlas::allocate_(Dimensions dims)
+{
+    Dimensions atlas_dims = dimensions();
+
+    if (cursor_.x + dims.width > atlas_dims.width) {
+        cursor_ = {0, cursor_.y + shelf_height_ + atlas_padding};
+        shelf_height_ = 0;
+    }
+
+    if (cursor_.x + dims.width > atlas_dims.width ||
+        cursor_.y + dims.height > atlas_dims.height) {
+        throw Client_logic_error{"Sprite_atlas::pack: atlas is full"};
+    }
+
+    Rectangle result = Rectangle::from_top_left(cursor_, dims);
+    cursor_.x += dims.width + atlas_padding;
+    shelf_height_ = std::max(shelf_height_, dims.height);
+
+    return result;
+}
+
+void Sprite_atlas::pack(Render_sprite& sprite)
+{
+    SDL_Surface* dst = texture_.as_surface();
+    if (!dst)
+        throw Client_logic_error{"Sprite_atlas::pack: atlas already rendered"};
+
+    SDL_Surface* src = sprite.texture_.as_surface();
+    if (!src)
+        throw Client_logic_error{"Sprite_atlas::pack: sprite already "
+                                 "rendered or packed"};
+
+    Rectangle region = allocate_({src->w, src->h});
+    SDL_Rect dst_rect = region;
+
+    // Copy the pixels as they are, alpha included, rather than blending
+    // them onto the (transparent) atlas.
+    SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_NONE);
+    if (SDL_BlitSurface(src, nullptr, dst, &dst_rect) < 0)
+        throw Host_error{"Sprite_atlas::pack: could not copy sprite"};
+
+    sprite.texture_ = Texture{texture_, region};
+}
+
+static Dimensions check_batch_dimensions(Dimensions dims)
+{
+    if (dims.width <= 0 || dims.height <= 0) {
+        throw Client_logic_error(
+                "Circle_batch_sprite: width and height must both be positive");
+    }
+
+    return dims;
+}
+
+// The smallest rectangle containing both, where an empty rectangle
+// contains nothing.
+static Rectangle bounding_union(Rectangle a, Rectangle b)
+{
+    if (a.width <= 0 || a.height <= 0) return b;
+    if (b.width <= 0 || b.height <= 0) return a;
+
+    int left = std::min(a.x, b.x);
+    int top = std::min(a.y, b.y);
+    int right = std::max(a.x + a.width, b.x + b.width);
+    int bottom = std::max(a.y + a.height, b.y + b.height);
+
+    return {left, top, right - left, bottom - top};
+}
+
+Circle_batch_sprite::Circle_batch_sprite(Dimensions dims)
+        : dimensions_{check_batch_dimensions(dims)}
+{ }
+
+void Circle_batch_sprite::clear() noexcept
+{
+    circles_.clear();
+    bounds_ = {0, 0, 0, 0};
+}
+
+void Circle_batch_sprite::reserve(size_t count)
+{
+    circles_.reserve(count);
+}
+
+size_t Circle_batch_sprite::size() const noexcept
+{
+    return circles_.size();
+}
+
+Dimensions Circle_batch_sprite::dimensions() const
+{
+    return dimensions_;
+}
+
+void Circle_batch_sprite::add_circle(Position top_left, int radius,
+                                     Color color)
+{
+    if (radius <= 0) {
+        throw Client_logic_error(
+                "Circle_batch_sprite::add_circle: radius must be positive");
+    }
+
+    int left = std::max(top_left.x, 0);
+    int top = std::max(top_left.y, 0);
+    int right = std::min(top_left.x + 2 * radius, dimensions_.width);
+    int bottom = std::min(top_left.y + 2 * radius, dimensions_.height);
+
+    // Entirely off the canvas.
+    if (left >= right || top >= bottom) return;
+
+    compute_spans_(radius);
+
+    // The texture's format is ARGB8888.
+    uint32_t pixel = uint32_t(color.alpha()) << 24 |
+                     uint32_t(color.red()) << 16 |
+                     uint32_t(color.green()) << 8 |
+                     uint32_t(color.blue());
+
+    circles_.push_back({top_left, radius, pixel});
+    bounds_ = bounding_union(bounds_,
+                             {left, top, right - left, bottom - top});
+}
+
+void Circle_batch_sprite::compute_spans_(int radius)
+{
+    if (size_t(radius) < spans_by_radius_.size() &&
+        !spans_by_radius_[radius].empty())
+        return;
+
+    if (size_t(radius) >= spans_by_radius_.size())
+        spans_by_radius_.resize(radius + 1);
+
+    // Row y of the lower half covers the pixels x of the right half with
+    // x * x + y * y < radius * radius, just like Circle_sprite; the upper
+    // half is the mirror image.
+    std::vector<int>& spans = spans_by_radius_[radius];
+    spans.resize(2 * radius);
+
+    for (int y = 0; y < radius; ++y) {
+        int half = circle_half_width(radius, y);
+        spans[radius + y] = half;
+        spans[radius - y - 1] = half;
+    }
+}
+
+void Circle_batch_sprite::rasterize_(uint32_t* pixels, int pitch,
+                                     Rectangle locked) const
+{
+    auto row = [=](int y) {
+        return reinterpret_cast<uint32_t*>(
+                reinterpret_cast<char*>(pixels) + size_t(y) * pitch);
+    };
+
+    for (int y = 0; y < locked.height; ++y)
+        std::fill_n(row(y), locked.width, uint32_t(0));
+
+    // Every circle was clipped to bounds_, which is inside the locked
+    // region, so we only need to clip against the locked region here.
+    // The span fills are plain loops over contiguous pixels, which the
+    // compiler vectorizes.
+    int x_end = locked.x + locked.width;
+    int y_end = locked.y + locked.height;
+
+    for (const Circle_& circle : circles_) {
+        const std::vector<int>& spans = spans_by_radius_[circle.radius];
+        int cx = circle.top_left.x + circle.radius;
+        int y_begin = std::max(circle.top_left.y, locked.y);
+        int y_stop = std::min(circle.top_left.y + 2 * circle.radius, y_end);
+
+        for (int y = y_begin; y < y_stop; ++y) {
+            int half = spans[y - circle.top_left.y];
+            int x0 = std::max(cx - half, locked.x);
+            int x1 = std::min(cx + half, x_end);
+            if (x0 >= x1) continue;
+
+            uint32_t* dst = row(y - locked.y);
+            std::fill(dst + (x0 - locked.x), dst + (x1 - locked.x),
+                      circle.pixel);
+        }
+    }
+}
+
+void Circle_batch_sprite::render(Renderer& renderer,
+                                 Position position,
+                                 const Transform& transform) const
+{
+    if (texture_.empty()) {
+        texture_ = renderer.create_streaming_texture(dimensions_);
+        // A new texture's contents are undefined, so all of it needs
+        // clearing.
+        painted_ = {0, 0, dimensions_.width, dimensions_.height};
+    }
+
+    Rectangle dirty = bounding_union(bounds_, painted_);
+
+    if (dirty.width > 0 && dirty.height > 0) {
+        int pitch;
+        if (uint32_t* pixels = texture_.lock(dirty, pitch)) {
+            rasterize_(pixels, pitch, dirty);
+            texture_.unlock();
+            painted_ = bounds_;
+        }
+    }
+
+    if (transform.is_identity())
+        renderer.copy(texture_, position);
+    else
+        renderer.copy(texture_, position, transform);
+}
+
+static Dimensions check_layer_dimensions(Dimensions dims)
+{
+    if (dims.width <= 0 || dims.height <= 0) {
+        throw Client_logic_error(
+                "Layer_sprite: width and height must both be positive");
+    }
+
+    return dims;
+}
+
+Layer_sprite::Layer_sprite(Dimensions dims)
+        : dimensions_{check_layer_dimensions(dims)}
+{ }
+
+Layer_sprite& Layer_sprite::add_sprite(const Sprite& sprite, Position xy,
+                                       int z, const Transform& t)
+{
+    contents_.emplace_back(sprite, xy, z, t);
+    dirty_ = true;
+    return *this;
+}
+
+Layer_sprite& Layer_sprite::add_sprite(const Sprite& sprite, Position xy,
+                                       int z)
+{
+    return add_sprite(sprite, xy, z, Transform{});
+}
+
+void Layer_sprite::clear()
+{
+    contents_.clear();
+    dirty_ = true;
+}
+
+void Layer_sprite::invalidate() noexcept
+{
+    dirty_ = true;
+}
+
+Dimensions Layer_sprite::dimensions() const
+{
+    return dimensions_;
+}
+
+void Layer_sprite::bake_(Renderer& renderer) const
+{
+    if (texture_.empty())
+        texture_ = renderer.create_target_texture(dimensions_);
+
+    sort_by_z(contents_, sort_buffer_);
+
+    {
+        // The sprites blend into the transparent texture as they would
+        // into the frame, which leaves its colors premultiplied by alpha.
+        Renderer::Target_scope target(renderer, texture_);
+
+        renderer.set_color(Color{0, 0, 0, 0});
+        renderer.clear();
+        for (const Placed_sprite& placed : contents_)
+            placed.render(renderer);
+    }
+
+    dirty_ = false;
+    baked_generation_ = renderer.target_generation();
+}
+
+void Layer_sprite::render(Renderer& renderer,
+                          Position position,
+                          const Transform& transform) const
+{
+    if (!renderer.supports_targets()) {
+        sort_by_z(contents_, sort_buffer_);
+        for (const Placed_sprite& placed : contents_) {
+            Placed_sprite moved = placed;
+            moved.xy = moved.xy + (position - Position{0, 0});
+            moved.render(renderer);
+        }
+        return;
+    }
+
+    if (dirty_ || baked_generation_ != renderer.target_generation())
+        bake_(renderer);
+
+    if (transform.is_identity())
+        renderer.copy(texture_, position);
+    else
+        renderer.copy(texture_, position, transform);
+}
+
 } // end namespace sprites
 
 }
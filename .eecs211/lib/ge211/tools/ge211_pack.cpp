@@ -0,0 +1,132 @@
+// Builds a resource pack for detail::Resource_pack (see ge211_pack.h for
+// the format).
+//
+// Usage: ge211_pack <output> <file>...
+//
+// Each file is stored under its name without the directory. When two
+// files have the same name, the one given later wins, so list the
+// built-in resources before the project's own, which should override
+// them.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace {
+
+// These must agree with detail::Resource_pack.
+char const magic[8] = {'G', 'E', '2', '1', '1', 'P', 'A', 'K'};
+uint32_t const version = 1;
+size_t const header_size = 16;
+size_t const entry_size = 24;
+size_t const pack_alignment = 16;
+
+using Bytes = std::vector<unsigned char>;
+
+void put_u32(Bytes& out, size_t at, uint64_t value)
+{
+    for (int i = 0; i < 4; ++i)
+        out[at + i] = (unsigned char) (value >> (8 * i));
+}
+
+void put_u64(Bytes& out, size_t at, uint64_t value)
+{
+    put_u32(out, at, value & 0xFFFFFFFF);
+    put_u32(out, at + 4, value >> 32);
+}
+
+size_t align(size_t offset)
+{
+    return (offset + pack_alignment - 1) / pack_alignment * pack_alignment;
+}
+
+std::string base_name(std::string const& path)
+{
+    size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+bool read_file(std::string const& path, Bytes& contents)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    contents.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+    return !in.bad();
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <output> <file>...\n";
+        return 2;
+    }
+
+    // Sorted by name, which is the order the directory needs.
+    std::map<std::string, Bytes> files;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string name = base_name(argv[i]);
+        if (name.empty()) continue;
+
+        if (!read_file(argv[i], files[name])) {
+            std::cerr << argv[0] << ": could not read " << argv[i] << "\n";
+            return 1;
+        }
+    }
+
+    size_t names_offset = header_size + files.size() * entry_size;
+    size_t data_offset = names_offset;
+    for (auto const& file : files)
+        data_offset += file.first.size();
+
+    size_t total = data_offset;
+    for (auto const& file : files)
+        total = align(total) + file.second.size();
+
+    Bytes pack(total, 0);
+    std::copy(std::begin(magic), std::end(magic), pack.begin());
+    put_u32(pack, 8, version);
+    put_u32(pack, 12, files.size());
+
+    size_t entry = header_size;
+    size_t name_at = names_offset;
+    size_t data_at = data_offset;
+
+    for (auto const& file : files) {
+        data_at = align(data_at);
+
+        put_u64(pack, entry, data_at);
+        put_u64(pack, entry + 8, file.second.size());
+        put_u32(pack, entry + 16, name_at);
+        put_u32(pack, entry + 20, file.first.size());
+
+        std::copy(file.first.begin(), file.first.end(),
+                  pack.begin() + name_at);
+        std::copy(file.second.begin(), file.second.end(),
+                  pack.begin() + data_at);
+
+        entry += entry_size;
+        name_at += file.first.size();
+        data_at += file.second.size();
+    }
+
+    std::ofstream out(argv[1], std::ios::binary);
+    out.write(reinterpret_cast<char const*>(pack.data()), pack.size());
+
+    if (!out) {
+        std::cerr << argv[0] << ": could not write " << argv[1] << "\n";
+        std::remove(argv[1]);
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,66 @@
+// Benchmark for the particle pool.
+//
+// Fills a pool of `particle_count` particles and reports the average time
+// to move them one frame, to draw them into a Circle_batch_sprite, and to
+// render that batch, next to the time a frame has at 60 fps.
+//
+// This renders offscreen and does not open a window.
+
+#include "../src/particles.h"
+#include "../.eecs211/lib/ge211/include/ge211.h"
+
+#include <iomanip>
+#include <iostream>
+
+using namespace ge211;
+using namespace std;
+
+// CONSTANTS
+
+size_t const particle_count{100000};
+int const timed_frames{10};
+double const frame_budget_ms{1000 / 60.0};
+Dimensions const screen{800, 400};
+
+int main()
+{
+    Offscreen_renderer offscreen(screen);
+    Camera camera({0, 0, screen.width, screen.height});
+    Circle_batch_sprite batch(screen);
+
+    Particle_system particles(particle_count);
+    for (int i = 0; i < 250; ++i) {
+        Position center{i * 37 % screen.width, i * 53 % screen.height};
+        particles.emit({center, 400, 50, 100, 100, Color::medium_red()});
+    }
+
+    double update_ms = 0;
+    double draw_ms = 0;
+    double render_ms = 0;
+
+    for (int frame = 0; frame < timed_frames; ++frame) {
+        Timer timer;
+        particles.update(1 / 60.0);
+        update_ms += timer.reset().seconds() * 1000;
+
+        batch.clear();
+        particles.draw(batch, camera, 1);
+        draw_ms += timer.reset().seconds() * 1000;
+
+        offscreen.render([&](Sprite_set& sprites) {
+            sprites.add_sprite(batch, {0, 0});
+        });
+        render_ms += timer.elapsed_time().seconds() * 1000;
+    }
+
+    cout << particles.size() << " particles, " << batch.size()
+         << " on screen\n";
+    cout << fixed << setprecision(3);
+    cout << setw(10) << "update" << setw(10) << update_ms / timed_frames
+         << " ms\n";
+    cout << setw(10) << "draw" << setw(10) << draw_ms / timed_frames
+         << " ms\n";
+    cout << setw(10) << "render" << setw(10) << render_ms / timed_frames
+         << " ms\n";
+    cout << setw(10) << "budget" << setw(10) << frame_budget_ms << " ms\n";
+}
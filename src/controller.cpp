@@ -4,13 +4,29 @@
 
 #include "controller.h"
 
+#include <algorithm>
+
 using namespace ge211;
 
+// how much each press of + or - zooms, and how far
+double const zoom_step = 1.25;
+double const max_zoom = 4;
+
 Controller::Controller()
         : model_()
-        , view_(model_)
+        , view_(model_, loader_)
+        , governor_(ge211::Duration(1) / default_frame_rate)
 {}
 
+void Controller::on_start()
+{
+    //everything is sent to the graphics card before the first frame, so
+    //the first frame is as quick as the rest
+    for (ge211::Sprite const* sprite : view_.finish_loading()) {
+        prepare(*sprite);
+    }
+}
+
 void Controller::draw(Sprite_set& sprites)
 {
     view_.draw(sprites);
@@ -27,6 +43,14 @@ std::string Controller::initial_window_title() const
 }
 
 void Controller::on_key_up(ge211::Key key) {
+    if (key == ge211::Key::code('=') || key == ge211::Key::code('+')) {
+        Camera& camera = view_.camera();
+        camera.set_zoom(std::min(max_zoom, camera.get_zoom() * zoom_step));
+    }
+    if (key == ge211::Key::code('-')) {
+        Camera& camera = view_.camera();
+        camera.set_zoom(std::max(1.0, camera.get_zoom() / zoom_step));
+    }
     if (key == ge211::Key::code(' ')) {
         if (model_.check_touching(model_.red_)) {
             model_.update_turret(model_.red_);
@@ -47,86 +71,80 @@ void Controller::on_key_up(ge211::Key key) {
             }
         }
     }
-    if (key == ge211::Key::code('w')) {
-        ru_ = false;
-    }
-    if (key == ge211::Key::code('a')) {
-        rl_ = false;
-    }
-    if (key == ge211::Key::code('s')) {
-        rd_ = false;
-    }
-    if (key == ge211::Key::code('d')) {
-        rr_ = false;
-    }
-    if (key == ge211::Key::up()) {
-        bu_ = false;
-    }
-    if (key == ge211::Key::right()) {
-        br_ = false;
-    }
-    if (key == ge211::Key::down()) {
-        bd_ = false;
-    }
-    if (key == ge211::Key::left()) {
-        bl_ = false;
-    }
 }
 
-void Controller::on_key_down(ge211::Key key) {
-    if (key == ge211::Key::code('w')) {
-        ru_ = true;
-    }
-    if (key == ge211::Key::code('a')) {
-        rl_ = true;
-    }
-    if (key == ge211::Key::code('s')) {
-        rd_ = true;
-    }
-    if (key == ge211::Key::code('d')) {
-        rr_ = true;
-    }
-    if (key == ge211::Key::up()) {
-        bu_ = true;
-    }
-    if (key == ge211::Key::right()) {
-        br_ = true;
-    }
-    if (key == ge211::Key::down()) {
-        bd_ = true;
-    }
-    if (key == ge211::Key::left()) {
-        bl_ = true;
-    }
+void Controller::on_key_down(ge211::Key) {
+    //movement keys are read from the keyboard in on_frame, which is more
+    //up to date than tracking key presses. Overriding this also keeps
+    //Escape from quitting in the middle of a match.
+}
+
+void Controller::on_focus_lost()
+{
+    paused_ = true;
 }
 
-void Controller::on_frame(double) {
-    if (ru_) {
+void Controller::on_focus_gained()
+{
+    paused_ = false;
+}
+
+void Controller::on_frame(double dt) {
+    //while the window is in the background, neither player can play, so
+    //the match waits for them, and the engine sleeps
+    if (paused_) return;
+
+    //the keyboard is sampled right before this frame, so movement uses
+    //the freshest input there is
+    if (is_key_down(ge211::Key::code('w'))) {
         model_.red_.move_up();
     }
-    if (rl_) {
+    if (is_key_down(ge211::Key::code('a'))) {
         model_.red_.move_left();
     }
-    if (rd_) {
+    if (is_key_down(ge211::Key::code('s'))) {
         model_.red_.move_down();
     }
-    if (rr_) {
+    if (is_key_down(ge211::Key::code('d'))) {
         model_.red_.move_right();
     }
-    if (bu_) {
+    if (is_key_down(ge211::Key::up())) {
         model_.blue_.move_up();
     }
-    if (br_) {
+    if (is_key_down(ge211::Key::right())) {
         model_.blue_.move_right();
     }
-    if (bd_) {
+    if (is_key_down(ge211::Key::down())) {
         model_.blue_.move_down();
     }
-    if (bl_) {
+    if (is_key_down(ge211::Key::left())) {
         model_.blue_.move_left();
     }
+    view_.update_effects(dt);
     if (model_.get_winner() == Player::neither) {
         model_.update(rand());
+        view_.show_impacts(model_.get_impacts());
     }
 
+    //when zoomed in, the camera follows the players, but never shows
+    //anything outside the arena
+    ge211::Position red = model_.red_.get_position();
+    ge211::Position blue = model_.blue_.get_position();
+    view_.camera()
+            .set_center({(red.x + blue.x) / 2.0, (red.y + blue.y) / 2.0})
+            .keep_within({0, 0, width_, height_});
+
+    //once someone has won and the last effects are gone, nothing moves
+    //on its own, so the engine can sleep until there is input
+    set_idle(model_.get_winner() != Player::neither &&
+             !view_.has_effects());
+
+    //only how the game is drawn degrades when frames take too long; the
+    //model above always runs in full
+    if (get_target_frame_rate() > 0) {
+        governor_.set_budget(ge211::Duration(1) / get_target_frame_rate());
+    }
+    if (governor_.record_frame(get_prev_frame_busy_time())) {
+        view_.set_quality(governor_.level());
+    }
 }
\ No newline at end of file
@@ -13,6 +13,7 @@
 // Need to add later on
 
 #include "model.h"
+#include "quality.h"
 #include "view.h"
 #include "../.eecs211/lib/ge211/include/ge211_base.h"
 
@@ -30,17 +31,21 @@ protected:
     void on_key_up(ge211::Key key) override;
     void on_key_down(ge211::Key) override;
     void on_frame(double) override;
+    void on_start() override;
+    void on_focus_lost() override;
+    void on_focus_gained() override;
 
 private:
 
+    // loads assets in the background; declared before the view, which
+    // starts loading in its constructor
+    ge211::Loader    loader_;
     Model            model_;
     View             view_;
-    bool bd_ = false;
-    bool ru_ = false;
-    bool br_ = false;
-    bool bl_ = false;
-    bool bu_ = false;
-    bool rl_ = false;
-    bool rr_ = false;
-    bool rd_ = false;
+
+    // lowers the view's quality when frames take too long
+    Quality_governor governor_;
+
+    // the match stands still while the window doesn't have the focus
+    bool paused_ = false;
 };
\ No newline at end of file
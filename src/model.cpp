@@ -256,11 +256,16 @@ std::vector<Turret> Model::get_turret() const {
     return list_of_turrets_;
 }
 
+std::vector<Impact> const& Model::get_impacts() const {
+    return impacts_;
+}
+
 void Model::add_turret(Turret t) {
     list_of_turrets_.push_back(t);
 }
 
 void Model::update(int x) {
+    impacts_.clear();
     update_balls();
     fire_all_turrets(x);
     game_over();
@@ -312,10 +317,16 @@ void Model::update_balls() {
 
         //if collision against player: give one player money and hurt the other, destroy ball
         if (future_ball.hit_character(red_)) {
+            impacts_.push_back({Impact::Kind::character_hit,
+                                future_ball.get_player(),
+                                future_ball.get_position()});
             destroy_ball(list_of_balls_[i]);
             red_.change_lives();
             blue_.change_money(hit_char_earnings_);
         } else if (future_ball.hit_character(blue_)) {
+            impacts_.push_back({Impact::Kind::character_hit,
+                                future_ball.get_player(),
+                                future_ball.get_position()});
             destroy_ball(list_of_balls_[i]);
             blue_.change_lives();
             red_.change_money(hit_char_earnings_);
@@ -329,10 +340,16 @@ void Model::update_balls() {
 
             //still check for collision with side too - gives a player money, reflects ball, and increments bounce_count
             if (future_ball.hit_left_wall()) {
+                impacts_.push_back({Impact::Kind::wall_bounce,
+                                    future_ball.get_player(),
+                                    future_ball.get_position()});
                 list_of_balls_[i].bounce_x();
                 red_.change_money(hit_side_earnings_);
             }
             if (future_ball.hit_right_wall()) {
+                impacts_.push_back({Impact::Kind::wall_bounce,
+                                    future_ball.get_player(),
+                                    future_ball.get_position()});
                 list_of_balls_[i].bounce_x();
                 blue_.change_money(hit_side_earnings_);
             }
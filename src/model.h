@@ -198,6 +198,25 @@ public:
     ge211::Position top_left() const;
 };
 
+// Something a ball ran into during an update. The model keeps the last
+// update's impacts so the view can show them.
+struct Impact
+{
+    enum class Kind
+    {
+        // the ball hit a character and is gone
+        character_hit,
+        // the ball bounced off the left or right wall
+        wall_bounce,
+    };
+
+    Kind kind;
+    // who shot the ball
+    Player player;
+    // the center of the ball when it hit
+    ge211::Position position;
+};
+
 class Model {
 
     //
@@ -220,6 +239,9 @@ public:
     // Gets the list of turrets that are active in the game
     std::vector<Turret> get_turret() const;
 
+    // Gets what the balls ran into during the most recent update
+    std::vector<Impact> const& get_impacts() const;
+
     // Adds turret to board
     void add_turret(Turret);
 
@@ -240,6 +262,7 @@ public:
 private:
     std::vector<Ball> list_of_balls_;
     std::vector<Turret> list_of_turrets_;
+    std::vector<Impact> impacts_;
     Player winner_;
     // For Ball:
 
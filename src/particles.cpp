@@ -0,0 +1,134 @@
+#include "particles.h"
+
+#include <algorithm>
+#include <cmath>
+
+float const Particle_system::drag = 0.05f;
+
+static float const two_pi = 6.2831853f;
+
+Particle_system::Particle_system(size_t capacity)
+        : x_(capacity)
+        , y_(capacity)
+        , vx_(capacity)
+        , vy_(capacity)
+        , life_(capacity)
+        , fade_(capacity)
+        , color_(capacity)
+{}
+
+size_t Particle_system::emit(Burst const& burst)
+{
+    size_t count = std::min(size_t(std::max(burst.count, 0)),
+                            capacity() - size_);
+
+    std::uniform_real_distribution<float> angle(0, two_pi);
+    std::uniform_real_distribution<float> speed(burst.min_speed,
+                                                burst.max_speed);
+
+    for (size_t i = size_; i < size_ + count; ++i) {
+        float a = angle(rng_);
+        float s = speed(rng_);
+
+        x_[i] = float(burst.center.x);
+        y_[i] = float(burst.center.y);
+        vx_[i] = s * std::cos(a);
+        vy_[i] = s * std::sin(a);
+        life_[i] = burst.lifetime;
+        fade_[i] = 1 / burst.lifetime;
+        color_[i] = burst.color;
+    }
+
+    size_ += count;
+    return count;
+}
+
+void Particle_system::update(double dt)
+{
+    float const step = float(dt);
+    float const keep = std::pow(drag, step);
+    // How far a particle goes this step per unit of its starting speed,
+    // with its speed falling all the while, so that the path is the same
+    // whatever the frame rate.
+    float const travel = (1 - keep) / std::log(1 / drag);
+
+    // Local pointers and separate loops, so each loop is a simple pass
+    // over whole arrays that the compiler vectorizes.
+    float* x = x_.data();
+    float* y = y_.data();
+    float* vx = vx_.data();
+    float* vy = vy_.data();
+    float* life = life_.data();
+    size_t const n = size_;
+
+    for (size_t i = 0; i < n; ++i) {
+        x[i] += vx[i] * travel;
+        y[i] += vy[i] * travel;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        vx[i] *= keep;
+        vy[i] *= keep;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        life[i] -= step;
+    }
+
+    // Fill each burned-out particle's slot with the last live one. The
+    // order of the particles doesn't matter.
+    size_t i = 0;
+    while (i < size_) {
+        if (life[i] <= 0) {
+            move_(--size_, i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+void Particle_system::move_(size_t from, size_t to)
+{
+    x_[to] = x_[from];
+    y_[to] = y_[from];
+    vx_[to] = vx_[from];
+    vy_[to] = vy_[from];
+    life_[to] = life_[from];
+    fade_[to] = fade_[from];
+    color_[to] = color_[from];
+}
+
+void Particle_system::draw(ge211::Circle_batch_sprite& batch,
+                           ge211::Camera const& camera,
+                           int radius) const
+{
+    // The camera's mapping from world to screen, worked out once rather
+    // than for every particle.
+    ge211::Rectangle const viewport = camera.get_viewport();
+    float const zoom = float(camera.get_zoom());
+    float const left = float(camera.get_center().x) -
+                       viewport.width / (2 * zoom);
+    float const top = float(camera.get_center().y) -
+                      viewport.height / (2 * zoom);
+    float const right = left + viewport.width / zoom;
+    float const bottom = top + viewport.height / zoom;
+
+    batch.reserve(batch.size() + size_);
+
+    for (size_t i = 0; i < size_; ++i) {
+        float x = x_[i];
+        float y = y_[i];
+        if (x < left || x >= right || y < top || y >= bottom) continue;
+
+        ge211::Position corner {
+                viewport.x + int((x - left) * zoom) - radius,
+                viewport.y + int((y - top) * zoom) - radius};
+
+        ge211::Color c = color_[i];
+        float share = std::min(1.0f, life_[i] * fade_[i]);
+        ge211::Color faded {c.red(), c.green(), c.blue(),
+                            uint8_t(c.alpha() * share)};
+
+        batch.add_circle(corner, radius, faded);
+    }
+}
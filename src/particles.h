@@ -0,0 +1,84 @@
+#pragma once
+
+#include "../.eecs211/lib/ge211/include/ge211_camera.h"
+#include "../.eecs211/lib/ge211/include/ge211_color.h"
+#include "../.eecs211/lib/ge211/include/ge211_sprites.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// A burst of particles flying out of one point in every direction, such
+// as the sparks where a ball hits something.
+struct Burst
+{
+    // where the particles start, in the world
+    ge211::Position center;
+    // how many particles
+    int count;
+    // how fast they start out, in pixels per second
+    float min_speed;
+    float max_speed;
+    // how long they last, in seconds
+    float lifetime;
+    ge211::Color color;
+};
+
+// Short-lived visual effects made of many small particles, which move in
+// straight lines, slow down and fade out.
+//
+// The system has a fixed number of particles, all allocated up front, so
+// emitting never allocates; when they are all in use, bursts come out
+// smaller. Each property of the particles is kept in its own array, with
+// the live particles first, so moving them all is a few plain loops over
+// contiguous floats that the compiler vectorizes. The particles are drawn
+// as dots into one Circle_batch_sprite, which is a single copy however
+// many there are.
+class Particle_system
+{
+public:
+    // how quickly particles slow down: each second they keep this share
+    // of their speed
+    static float const drag;
+
+    // Makes room for at most the given number of live particles.
+    explicit Particle_system(size_t capacity);
+
+    // The most particles that can be live at once.
+    size_t capacity() const { return x_.size(); }
+
+    // The number of live particles.
+    size_t size() const { return size_; }
+
+    // Adds the burst's particles, or as many as there is room for, and
+    // returns how many were added.
+    size_t emit(Burst const&);
+
+    // Moves every particle `dt` seconds on, and removes those that have
+    // burned out.
+    void update(double dt);
+
+    // Removes every particle.
+    void clear() { size_ = 0; }
+
+    // Adds every particle to the batch as a dot of the given radius,
+    // where the camera shows it, fading as it burns out.
+    void draw(ge211::Circle_batch_sprite&, ge211::Camera const&,
+              int radius) const;
+
+private:
+    // Moves particle `from` into slot `to`.
+    void move_(size_t from, size_t to);
+
+    // one element per particle in each; the first size_ are live
+    std::vector<float> x_, y_;
+    std::vector<float> vx_, vy_;
+    // seconds left, and one over the seconds it started with
+    std::vector<float> life_, fade_;
+    std::vector<ge211::Color> color_;
+
+    size_t size_ = 0;
+
+    std::minstd_rand rng_;
+};
@@ -0,0 +1,79 @@
+#include "quality.h"
+
+#include <algorithm>
+
+double const Quality_governor::high_mark = 0.9;
+double const Quality_governor::low_mark = 0.6;
+
+int const Quality_governor::down_hold = 10;
+int const Quality_governor::up_hold = 120;
+int const Quality_governor::max_up_hold = 1920;
+
+// how much each frame moves the smoothed frame time
+static double const smoothing = 0.1;
+
+double particle_share(Quality quality)
+{
+    return quality >= Quality::fewer_particles ? 0.25 : 1;
+}
+
+Quality_governor::Quality_governor(ge211::Duration budget)
+        : budget_(budget.seconds())
+{}
+
+void Quality_governor::set_budget(ge211::Duration budget)
+{
+    budget_ = budget.seconds();
+}
+
+bool Quality_governor::record_frame(ge211::Duration busy_time)
+{
+    double seconds = busy_time.seconds();
+
+    if (has_average_) {
+        average_ += smoothing * (seconds - average_);
+    } else {
+        average_ = seconds;
+        has_average_ = true;
+    }
+
+    if (frames_since_up_ < 2 * max_up_hold) {
+        ++frames_since_up_;
+    }
+
+    slow_frames_ = average_ > high_mark * budget_ ? slow_frames_ + 1 : 0;
+    fast_frames_ = average_ < low_mark * budget_ ? fast_frames_ + 1 : 0;
+
+    if (slow_frames_ >= down_hold && level_ != Quality::point_balls) {
+        //a step up that didn't fit; wait longer before trying again
+        if (stepped_up_ && frames_since_up_ < 2 * up_hold_) {
+            up_hold_ = std::min(2 * up_hold_, max_up_hold);
+        } else {
+            up_hold_ = up_hold;
+        }
+
+        stepped_up_ = false;
+        step_(1);
+        return true;
+    }
+
+    if (fast_frames_ >= up_hold_ && level_ != Quality::full) {
+        stepped_up_ = true;
+        frames_since_up_ = 0;
+        step_(-1);
+        return true;
+    }
+
+    return false;
+}
+
+void Quality_governor::step_(int direction)
+{
+    level_ = Quality(int(level_) + direction);
+
+    //the next step waits for frames made at the new level, so the
+    //average starts over rather than carrying the old level's times
+    has_average_ = false;
+    slow_frames_ = 0;
+    fast_frames_ = 0;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "../.eecs211/lib/ge211/include/ge211_time.h"
+
+//
+// Presentation quality
+//
+
+// How much of the presentation the view can afford, from everything down
+// to the least. Each level also gives up everything the levels before it
+// gave up. The simulation itself never changes; only how it is drawn.
+enum class Quality
+{
+    // everything
+    full,
+    // fewer particles in each effect
+    fewer_particles,
+    // the numbers in the text interface rendered without anti-aliasing
+    plain_text,
+    // the text interface updated only every other frame
+    alternate_hud,
+    // every ball drawn as a small dot in one batch, at any count
+    point_balls,
+};
+
+// The share of each effect's particles drawn at the given level.
+double particle_share(Quality);
+
+// Watches how long frames take to make against a budget, and steps the
+// quality down when they take too long and back up when there is room to
+// spare.
+//
+// Frame times are smoothed, and the quality only steps down after they
+// have been over the high mark for several frames in a row, and only back
+// up after a much longer stretch under the low mark. Between the two
+// marks nothing changes, so a game that just fits at some level stays
+// there. If a step up is quickly followed by a step down, the level above
+// evidently didn't fit, so the next step up waits twice as long.
+class Quality_governor
+{
+public:
+    // Frames over this share of the budget are too slow...
+    static double const high_mark;
+    // ...and frames under this one leave room to spare.
+    static double const low_mark;
+
+    // How many frames in a row need to be too slow before stepping down.
+    static int const down_hold;
+    // How many frames in a row need room to spare before stepping up, at
+    // first, and at most after backing off.
+    static int const up_hold;
+    static int const max_up_hold;
+
+    // Starts at full quality, aiming to make each frame in `budget`.
+    explicit Quality_governor(ge211::Duration budget);
+
+    // Changes the budget, such as when the target frame rate changes.
+    void set_budget(ge211::Duration budget);
+
+    // Records how long the engine was busy making a frame, and changes
+    // the level if the frames have been too slow or fast enough for long
+    // enough. Returns whether the level changed.
+    bool record_frame(ge211::Duration busy_time);
+
+    // The level the view should draw at.
+    Quality level() const { return level_; }
+
+    // The smoothed time it takes to make a frame, in seconds.
+    double average_seconds() const { return average_; }
+
+private:
+    void step_(int direction);
+
+    double budget_;
+    Quality level_ = Quality::full;
+
+    double average_ = 0;
+    bool has_average_ = false;
+
+    int slow_frames_ = 0;
+    int fast_frames_ = 0;
+
+    // how many fast frames the next step up waits for
+    int up_hold_ = up_hold;
+    // frames since the last step up, to notice one that didn't fit
+    int frames_since_up_ = 0;
+    bool stepped_up_ = false;
+};
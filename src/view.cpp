@@ -4,6 +4,8 @@
 
 #include "view.h"
 
+#include <algorithm>
+
 using namespace ge211;
 
 // constants for drawing the sprites:
@@ -24,159 +26,395 @@ ge211::Color const green_5 (0, 255 , 0);
 ge211::Dimensions const horidim {width_, 3};
 ge211::Dimensions const vertidim {3, height_};
 
+// more balls than this are drawn as one batch instead of one sprite each
+size_t const ball_batch_threshold = 1000;
+
+// the radius of a ball drawn as a dot, in pixels on screen
+int const point_ball_radius = 1;
+
+// the effects where balls hit things: a burst in the shooter's color when
+// a character is hit, and a few sparks off the side walls
+int const hit_particles = 400;
+int const bounce_particles = 40;
+int const particle_radius = 1;
+
 
-View::View(Model &model)
+View::View(Model &model, ge211::Loader& loader)
         : model_(model)
+        , sans_(loader.load_font("sans.ttf", 24).share())
+        , big_sans_(loader.load_font("sans.ttf", 48).share())
 // You may want to add sprite initialization here
-{ }
+{
+    // pack every shape into one texture so the renderer can batch them
+    ge211::Sprite_atlas atlas;
+
+    for (ge211::Circle_sprite* circle : {&player_, &ball}) {
+        atlas.pack(*circle);
+    }
 
-void View::draw(ge211::Sprite_set& set) const
+    for (ge211::Rectangle_sprite* rect : {&horiz_bound_, &verti_bound_,
+                                          &turret_}) {
+        atlas.pack(*rect);
+    }
+}
+
+std::vector<ge211::Sprite const*> View::finish_loading()
 {
-    //wot is just a position initializer
-    ge211::Position wot (0,0);
+    ge211::Font const& sans = sans_.get();
+    ge211::Font const& big_sans = big_sans_.get();
+
+    blue_win = ge211::Text_sprite("BLUE VICTORY", big_sans);
+    red_win = ge211::Text_sprite("RED VICTORY", big_sans);
+    lives_sprite_text = ge211::Text_sprite("Lives:", sans);
+    money_sprite_text = ge211::Text_sprite("Money:", sans);
+
+    update_number_(red_lives_sprite_, red_lives_shown_,
+                   model_.red_.get_lives());
+    update_number_(blue_lives_sprite_, blue_lives_shown_,
+                   model_.blue_.get_lives());
+    update_number_(red_money_sprite_, red_money_shown_,
+                   model_.red_.get_money());
+    update_number_(blue_money_sprite_, blue_money_shown_,
+                   model_.blue_.get_money());
+
+    //the shapes all share the atlas texture, so preparing one of them
+    //uploads all of them
+    return {&player_, &blue_win, &red_win,
+            &lives_sprite_text, &money_sprite_text,
+            &red_lives_sprite_, &blue_lives_sprite_,
+            &red_money_sprite_, &blue_money_sprite_};
+}
 
+void View::draw(ge211::Sprite_set& set)
+{
+    //everything that rarely changes is retained by the sprite set, so
+    //it only has to be added once and then updated when it changes
+    if (!background_handle_) {
+        build_scene_(set);
+    }
 
     //endgame screen
-    wot.y = 30;
-    if (model_.get_winner() == Player::blue){
-        wot.x = width_/4 * 3 - 20;
-        set.add_sprite(blue_win, wot, 5);
+    blue_win_handle_.set_visible(model_.get_winner() == Player::blue);
+    red_win_handle_.set_visible(model_.get_winner() == Player::red);
+
+    //the numbers in the text interface are only re-rendered when they
+    //change, and when frames are slow, only checked every other frame
+    ++frames_drawn_;
+    if (quality_ < Quality::alternate_hud || frames_drawn_ % 2 == 0) {
+        update_number_(red_lives_sprite_, red_lives_shown_,
+                       model_.red_.get_lives());
+        update_number_(blue_lives_sprite_, blue_lives_shown_,
+                       model_.blue_.get_lives());
+        update_number_(red_money_sprite_, red_money_shown_,
+                       model_.red_.get_money());
+        update_number_(blue_money_sprite_, blue_money_shown_,
+                       model_.blue_.get_money());
+    }
+
+    //the text interface stays put when zoomed in, so it covers up
+    //whatever spills out of the bottom of the arena
+    interface_backdrop_handle_.set_visible(camera_.get_zoom() > 1);
+
+    ge211::Transform const zoom = camera_.transform();
+    ge211::Dimensions const player_dims {2 * player_radius, 2 * player_radius};
+
+    background_handle_
+            .set_position(camera_.to_screen({0, 0}))
+            .set_transform(zoom);
+
+    //draw red player
+    red_player_handle_
+            .set_position(camera_.to_screen(model_.red_.top_left()))
+            .set_transform(ge211::Transform(zoom).set_tint(player_red_color))
+            .set_visible((model_.get_winner() == Player::neither ||
+                          model_.get_winner() == Player::red) &&
+                         camera_.can_see(ge211::Rectangle::from_top_left(
+                                 model_.red_.top_left(), player_dims)));
+
+    //draw blue player
+    blue_player_handle_
+            .set_position(camera_.to_screen(model_.blue_.top_left()))
+            .set_transform(ge211::Transform(zoom).set_tint(player_blue_color))
+            .set_visible((model_.get_winner() == Player::neither ||
+                          model_.get_winner() == Player::blue) &&
+                         camera_.can_see(ge211::Rectangle::from_top_left(
+                                 model_.blue_.top_left(), player_dims)));
+
+    //draw turrets, hiding those the camera can't see
+    std::vector<Turret> turrets = model_.get_turret();
+    ge211::Dimensions const turret_dims {turret_size, turret_size};
+
+    turret_grid_.clear();
+    for (size_t i = 0; i < turrets.size(); ++i) {
+        turret_grid_.insert(ge211::Rectangle::from_top_left(
+                turrets[i].top_left(), turret_dims), i);
+    }
+
+    turret_visible_.assign(turrets.size(), false);
+    turret_grid_.query(camera_.visible_area(), [&](size_t i) {
+        turret_visible_[i] = true;
+    });
+
+    while (turret_handles_.size() < turrets.size()) {
+        Turret const& t = turrets[turret_handles_.size()];
+        turret_handles_.push_back(set.add_retained(turret_, t.top_left(), 2));
     }
-    if (model_.get_winner() == Player::red){
-        wot.x = width_/4 - 20;
-        set.add_sprite(red_win, wot, 5);
+    turret_handles_.resize(turrets.size());
+
+    for (size_t i = 0; i < turrets.size(); ++i) {
+        turret_handles_[i]
+                .set_position(camera_.to_screen(turrets[i].top_left()))
+                .set_transform(ge211::Transform(zoom).set_tint(
+                        turret_color_(turrets[i].get_level())))
+                .set_visible(model_.get_winner() == Player::neither &&
+                             turret_visible_[i]);
+    }
+
+    //draw the effects over the balls, all as one batch
+    if (effects_.size() > 0) {
+        effect_batch_.clear();
+        effects_.draw(effect_batch_, camera_, particle_radius);
+        set.add_sprite(effect_batch_, {0, 0}, 4);
+    }
+
+    //draw balls: a few are cheapest as sprites, but past the threshold
+    //they are rasterized together into one texture. Either way, only
+    //those the camera can see are drawn.
+    std::vector<Ball> balls = model_.get_ball();
+    find_visible_balls_(balls);
+
+    if (quality_ >= Quality::point_balls) {
+        draw_point_balls_(set, balls);
+    } else if (visible_.size() > ball_batch_threshold) {
+        int radius = std::max(1, int(ball_radius * camera_.get_zoom()));
+        ball_batch_.clear();
+        for (size_t i : visible_) {
+            Ball const& b = balls[i];
+            if (b.get_player() != Player::neither) {
+                ball_batch_.add_circle(camera_.to_screen(b.top_left()),
+                                       radius, ball_color_(b));
+            }
+        }
+        set.add_sprite(ball_batch_, {0, 0}, 3);
+    } else {
+        set.reserve(visible_.size());
+        ge211::Transform tinted = zoom;
+        for (size_t i : visible_) {
+            Ball const& b = balls[i];
+            if (b.get_player() != Player::neither) {
+                tinted.set_tint(ball_color_(b));
+                set.add_sprite(ball, camera_.to_screen(b.top_left()), 3,
+                               tinted);
+            }
+        }
+    }
+}
+
+void View::draw_point_balls_(ge211::Sprite_set& set,
+                             std::vector<Ball> const& balls)
+{
+    //each dot is centered where the ball is, whatever the zoom
+    ge211::Dimensions const ball_half {ball_radius, ball_radius};
+    ge211::Dimensions const dot_half {point_ball_radius, point_ball_radius};
+
+    ball_batch_.clear();
+    ball_batch_.reserve(visible_.size());
+    for (size_t i : visible_) {
+        Ball const& b = balls[i];
+        if (b.get_player() != Player::neither) {
+            ge211::Position center =
+                    camera_.to_screen(b.top_left() + ball_half);
+            ball_batch_.add_circle(center - dot_half, point_ball_radius,
+                                   ball_color_(b));
+        }
+    }
+    set.add_sprite(ball_batch_, {0, 0}, 3);
+}
+
+void View::find_visible_balls_(std::vector<Ball> const& balls)
+{
+    ge211::Dimensions const ball_dims {2 * ball_radius, 2 * ball_radius};
+
+    ball_grid_.clear();
+    ball_grid_.reserve(balls.size());
+    for (size_t i = 0; i < balls.size(); ++i) {
+        ball_grid_.insert(ge211::Rectangle::from_top_left(
+                balls[i].top_left(), ball_dims), i);
+    }
+
+    visible_.clear();
+    ball_grid_.query(camera_.visible_area(), [&](size_t i) {
+        visible_.push_back(i);
+    });
+
+    //balls later in the list are drawn on top, as they would be without
+    //the grid
+    std::sort(visible_.begin(), visible_.end());
+}
+
+ge211::Camera& View::camera()
+{
+    return camera_;
+}
+
+ge211::Camera const& View::camera() const
+{
+    return camera_;
+}
+
+void View::set_quality(Quality quality)
+{
+    bool was_plain = quality_ >= Quality::plain_text;
+    quality_ = quality;
+
+    //forget the numbers shown, so they are rendered again in the new
+    //style
+    if (was_plain != (quality_ >= Quality::plain_text)) {
+        red_lives_shown_ = -1;
+        blue_lives_shown_ = -1;
+        red_money_shown_ = -1;
+        blue_money_shown_ = -1;
     }
+}
 
+void View::build_scene_(ge211::Sprite_set& set)
+{
+    //wot is just a position initializer
+    ge211::Position wot (0,0);
+
+    //endgame screen
+    wot.y = 30;
+    wot.x = width_/4 * 3 - 20;
+    blue_win_handle_ = set.add_retained(blue_win, wot, 5);
+    wot.x = width_/4 - 20;
+    red_win_handle_ = set.add_retained(red_win, wot, 5);
+
+    //the boundaries and the labels never change, so they are drawn
+    //once into the background and interface layers
     wot.x = 0;
     wot.y = 0;
     //draw boundaries of each player's area
-    set.add_sprite(horiz_bound_, wot, 1);
-    set.add_sprite(verti_bound_, wot, 1);
+    background_.add_sprite(horiz_bound_, wot);
+    background_.add_sprite(verti_bound_, wot);
 
     wot.y = height_ - 3;
-    set.add_sprite(horiz_bound_, wot, 1);
+    background_.add_sprite(horiz_bound_, wot);
 
     wot.y = 0;
     wot.x = width_/2 - 1;
-    set.add_sprite(verti_bound_, wot, 1);
+    background_.add_sprite(verti_bound_, wot);
 
     wot.x = width_ - 3;
-    set.add_sprite(verti_bound_, wot, 1);
+    background_.add_sprite(verti_bound_, wot);
 
     //draw the stationary text interface
 
-
         //red lives
-    int my_value = model_.red_.get_lives();
-
-    red_lives_sprite_.reconfigure(
-            ge211::Text_sprite::Builder(sans) << my_value);
     wot.x = width_/4;
     wot.y = height_ + 10;
-    set.add_sprite(red_lives_sprite_, wot, 10);
+    labels_.push_back(set.add_retained(red_lives_sprite_, wot, 10));
 
         //blue lives
-    my_value = model_.blue_.get_lives();
-
-    blue_lives_sprite_.reconfigure(
-            ge211::Text_sprite::Builder(sans) << my_value);
     wot.x = width_/4 * 3;
     wot.y = height_ + 10;
-    set.add_sprite(blue_lives_sprite_, wot, 10);
+    labels_.push_back(set.add_retained(blue_lives_sprite_, wot, 10));
 
-        //text for lives and money
+        //text for lives and money, relative to the interface layer
     wot.x = width_/4 - 100;
-    wot.y = height_ + 10;
-    set.add_sprite(lives_sprite_text, wot, 10);
+    wot.y = 10;
+    interface_layer_.add_sprite(lives_sprite_text, wot);
     wot.x = width_/4 * 3 - 100;
-    set.add_sprite(lives_sprite_text, wot, 10);
+    interface_layer_.add_sprite(lives_sprite_text, wot);
 
-    wot.y = height_ + 30;
-    set.add_sprite(money_sprite_text, wot, 10);
+    wot.y = 30;
+    interface_layer_.add_sprite(money_sprite_text, wot);
     wot.x = width_/4 - 100;
-    set.add_sprite(money_sprite_text, wot, 10);
-
+    interface_layer_.add_sprite(money_sprite_text, wot);
 
         //red money
-    my_value = model_.red_.get_money();
-
-    red_money_sprite_.reconfigure(
-            ge211::Text_sprite::Builder(sans) << my_value);
     wot.x = width_/4;
     wot.y = height_ + 30;
-    set.add_sprite(red_money_sprite_, wot, 10);
+    labels_.push_back(set.add_retained(red_money_sprite_, wot, 10));
 
         //blue money
-    my_value = model_.blue_.get_money();
-
-    blue_money_sprite_.reconfigure(
-            ge211::Text_sprite::Builder(sans) << my_value);
     wot.x = width_/4 * 3;
     wot.y = height_ + 30;
-    set.add_sprite(blue_money_sprite_, wot, 10);
+    labels_.push_back(set.add_retained(blue_money_sprite_, wot, 10));
 
+    background_handle_ = set.add_retained(background_, {0, 0}, 1);
+    interface_backdrop_handle_ =
+            set.add_retained(interface_backdrop_, {0, height_}, 4);
+    interface_layer_handle_ =
+            set.add_retained(interface_layer_, {0, height_}, 10);
 
-    if (model_.get_winner() == Player::neither || model_.get_winner() == Player::red) {
-        //draw red player
-        wot = model_.red_.top_left();
+    //players
+    red_player_handle_ = set.add_retained(player_, model_.red_.top_left(), 3);
+    blue_player_handle_ = set.add_retained(player_, model_.blue_.top_left(), 3);
+}
 
-        set.add_sprite(red_player_, wot, 3);
+void View::show_impacts(std::vector<Impact> const& impacts)
+{
+    //at lower quality each effect has fewer particles, but every impact
+    //still gets one
+    double share = particle_share(quality_);
+
+    for (Impact const& impact : impacts) {
+        ge211::Color color = impact.player == Player::red ? player_red_color
+                                                          : player_blue_color;
+
+        if (impact.kind == Impact::Kind::character_hit) {
+            effects_.emit({impact.position, int(hit_particles * share),
+                           60, 240, 0.6f, color});
+        } else {
+            effects_.emit({impact.position, int(bounce_particles * share),
+                           40, 160, 0.3f, color.lighten(0.5)});
+        }
     }
+}
 
+void View::update_effects(double dt)
+{
+    effects_.update(dt);
+}
 
-    //draw blue player
+bool View::has_effects() const
+{
+    return effects_.size() > 0;
+}
 
-    if (model_.get_winner() == Player::neither || model_.get_winner() == Player::blue) {
-        wot = model_.blue_.top_left();
-        set.add_sprite(blue_player_, wot, 3);
+void View::update_number_(ge211::Text_sprite& sprite, int& shown, int value)
+{
+    if (value != shown) {
+        sprite.reconfigure(ge211::Text_sprite::Builder(sans_.get())
+                                   .antialias(quality_ < Quality::plain_text)
+                           << value);
+        shown = value;
     }
+}
 
-    //draw turrets
-    // doesn't account for change in level
-
-    if (model_.get_winner() == Player::neither) {
-        for (Turret t : model_.get_turret()) {
-
-
-            if (t.get_level() == 1) {
-                set.add_sprite(turret_1, t.top_left(), 2);
-            }
-            if (t.get_level() == 2) {
-                set.add_sprite(turret_2, t.top_left(), 2);
-            }
-            if (t.get_level() == 3) {
-                set.add_sprite(turret_3, t.top_left(), 2);
-            }
-            if (t.get_level() == 4) {
-                set.add_sprite(turret_4, t.top_left(), 2);
-            }
-            if (t.get_level() == 5) {
-                set.add_sprite(turret_5, t.top_left(), 2);
-            }
-        }
+ge211::Color View::ball_color_(Ball const& b) const
+{
+    if (b.get_player() == Player::red) {
+        return b.get_bounce_count() == 0 ? ball_red_color : ball_red_color_1;
+    } else {
+        return b.get_bounce_count() == 0 ? ball_blue_color : ball_blue_color_1;
     }
+}
 
-    //draw balls
-    for (Ball b : model_.get_ball()) {
-        if (b.get_player() == Player::red) {
-            if (b.get_bounce_count() == 0) {
-                set.add_sprite(red_ball_0, b.top_left(), 3);
-            } else {
-                set.add_sprite(red_ball_1, b.top_left(), 3);
-            }
-        } else if (b.get_player() == Player::blue) {
-            if (b.get_bounce_count() == 0) {
-                set.add_sprite(blue_ball_0, b.top_left(), 3);
-            } else {
-                set.add_sprite(blue_ball_1, b.top_left(), 3);
-            }
-        }
+ge211::Color View::turret_color_(int level) const
+{
+    switch (level) {
+        case 1:
+            return green_1;
+        case 2:
+            return green_2;
+        case 3:
+            return green_3;
+        case 4:
+            return green_4;
+        default:
+            return green_5;
     }
-
-
-
-
-
 }
 
 Dimensions View::initial_window_dimensions() const
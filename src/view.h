@@ -13,85 +13,176 @@
 //do we need this?
 
 #include "model.h"
+#include "particles.h"
+#include "quality.h"
+#include "../.eecs211/lib/ge211/include/ge211_camera.h"
+#include "../.eecs211/lib/ge211/include/ge211_loader.h"
 #include "../.eecs211/lib/ge211/include/ge211_sprites.h"
 
+#include <future>
 #include <string>
+#include <vector>
 
 extern ge211::Color const white_color, player_red_color, ball_red_color, player_blue_color, ball_blue_color;
 extern ge211::Color const ball_red_color_1, ball_blue_color_1;
 extern ge211::Color const green_1, green_2, green_3, green_4, green_5;
 extern ge211::Dimensions const horidim, vertidim;
 
+// the size of the cells the view sorts balls and turrets into
+int const grid_cell_size = 64;
+
+// the most particles the hit effects can have at once
+size_t const effect_capacity = 100000;
+
 
 class View
 {
 public:
 
-    View(Model &);
+    // Starts loading the fonts on the loader's threads.
+    View(Model &, ge211::Loader&);
+
+    // Waits for the fonts, renders the text with them, and returns every
+    // sprite, so the controller can prepare them before the first frame.
+    std::vector<ge211::Sprite const*> finish_loading();
 
     // You will probably want to add arguments here so that the
     // controller can communicate UI state (such as a mouse or
     // cursor position):
-    void draw(ge211::Sprite_set&) const;
+    void draw(ge211::Sprite_set&);
 
-    ge211::Dimensions initial_window_dimensions() const;
+    // Maps the arena onto the part of the window above the text
+    // interface. Only what it can see is drawn.
+    ge211::Camera& camera();
+    ge211::Camera const& camera() const;
 
-    std::string initial_window_title() const;
+    // Sets how much of the presentation to draw, trading looks for speed
+    // when frames take too long.
+    void set_quality(Quality);
 
+    // Starts an effect for each of the impacts, such as a burst where a
+    // ball hit a character.
+    void show_impacts(std::vector<Impact> const&);
 
-private:
-    Model const& model_;
+    // Moves the effects `dt` seconds on.
+    void update_effects(double dt);
 
-    ge211::Circle_sprite const
-            red_player_ {player_radius, player_red_color};
+    // Are any effects still playing?
+    bool has_effects() const;
 
-    ge211::Circle_sprite const
-            blue_player_ {player_radius, player_blue_color};
+    ge211::Dimensions initial_window_dimensions() const;
 
-    ge211::Circle_sprite const
-            ball {ball_radius, white_color};
+    std::string initial_window_title() const;
 
-    ge211::Circle_sprite const
-            red_ball_0 {ball_radius, ball_red_color};
 
-    ge211::Circle_sprite const
-            blue_ball_0 {ball_radius, ball_blue_color};
+private:
+    Model const& model_;
 
-    ge211::Circle_sprite const
-            blue_ball_1 {ball_radius, ball_blue_color_1};
+    // Adds the retained sprites for the parts of the scene that rarely
+    // change. Called by the first draw.
+    void build_scene_(ge211::Sprite_set&);
 
-    ge211::Circle_sprite const
-            red_ball_1 {ball_radius, ball_red_color_1};
+    // Re-renders a number in the text interface if it has changed.
+    void update_number_(ge211::Text_sprite&, int& shown, int value);
 
-    ge211::Rectangle_sprite const
-            horiz_bound_ {horidim, white_color};
-    ge211::Rectangle_sprite const
-            verti_bound_ {vertidim, white_color};
+    // Draws the visible balls as dots in the batch, at any count.
+    void draw_point_balls_(ge211::Sprite_set&,
+                           std::vector<Ball> const&);
 
-    ge211::Rectangle_sprite const
-            turret_1 {{turret_size, turret_size}, green_1};
-    ge211::Rectangle_sprite const
-            turret_2 {{turret_size, turret_size}, green_2};
-    ge211::Rectangle_sprite const
-            turret_3 {{turret_size, turret_size}, green_3};
-    ge211::Rectangle_sprite const
-            turret_4 {{turret_size, turret_size}, green_4};
-    ge211::Rectangle_sprite const
-            turret_5 {{turret_size, turret_size}, green_5};
+    // The color of a turret, by level
+    ge211::Color turret_color_(int level) const;
 
+    // The color of a ball, by team and bounce count
+    ge211::Color ball_color_(Ball const&) const;
 
+    // Fills in visible_, sorted, with the indices of the balls the
+    // camera can see.
+    void find_visible_balls_(std::vector<Ball> const&);
 
-    ge211::Font sans{"sans.ttf", 24};
-    ge211::Text_sprite mutable blue_lives_sprite_  {"hello world", sans};
-    ge211::Text_sprite mutable red_lives_sprite_  {"hello world", sans};
-    ge211::Text_sprite mutable blue_money_sprite_  {"hello world", sans};
-    ge211::Text_sprite mutable red_money_sprite_  {"hello world", sans};
+    // the shapes are white, and tinted with the color of whatever they
+    // stand for when drawn, so one texture serves every team and level
+    ge211::Circle_sprite
+            player_ {player_radius, white_color};
 
+    ge211::Circle_sprite
+            ball {ball_radius, white_color};
+
+    // all the balls, when there are too many to draw one at a time
+    ge211::Circle_batch_sprite
+            ball_batch_ {{width_, height_}};
 
-    ge211::Font big_sans{"sans.ttf", 48};
-    ge211::Text_sprite mutable blue_win  {"BLUE VICTORY", big_sans};
-    ge211::Text_sprite mutable red_win  {"RED VICTORY", big_sans};
+    ge211::Rectangle_sprite
+            horiz_bound_ {horidim, white_color};
+    ge211::Rectangle_sprite
+            verti_bound_ {vertidim, white_color};
 
-    ge211::Text_sprite lives_sprite_text  {"Lives:", sans};
-    ge211::Text_sprite money_sprite_text  {"Money:", sans};
+    ge211::Rectangle_sprite
+            turret_ {{turret_size, turret_size}, white_color};
+
+    // loaded in the background; big_sans only loads the glyphs, since
+    // the file itself is shared with sans
+    std::shared_future<ge211::Font> sans_;
+    std::shared_future<ge211::Font> big_sans_;
+
+    // rendered by finish_loading once the fonts are ready
+    ge211::Text_sprite blue_lives_sprite_;
+    ge211::Text_sprite red_lives_sprite_;
+    ge211::Text_sprite blue_money_sprite_;
+    ge211::Text_sprite red_money_sprite_;
+
+    ge211::Text_sprite blue_win;
+    ge211::Text_sprite red_win;
+
+    ge211::Text_sprite lives_sprite_text;
+    ge211::Text_sprite money_sprite_text;
+
+    // the boundaries of the arena, composed once into a single texture
+    ge211::Layer_sprite background_ {{width_, height_}};
+
+    // the labels of the text interface, which don't move with the camera
+    ge211::Layer_sprite interface_layer_ {{width_, 100}};
+
+    // covers whatever zoomed sprites spill over the bottom of the arena
+    ge211::Rectangle_sprite
+            interface_backdrop_ {{width_, 100}, ge211::Color::black()};
+
+    ge211::Camera camera_ {{0, 0, width_, height_}};
+
+    // the balls and turrets by where they are, so drawing only looks at
+    // those the camera might see; rebuilt every frame
+    ge211::Spatial_grid<size_t> ball_grid_ {{0, 0, width_, height_},
+                                            grid_cell_size};
+    ge211::Spatial_grid<size_t> turret_grid_ {{0, 0, width_, height_},
+                                              grid_cell_size};
+
+    // the balls found by the last query, as indices into the model's list
+    std::vector<size_t> visible_;
+    std::vector<char> turret_visible_;
+
+    Quality quality_ = Quality::full;
+
+    // the sparks and bursts where balls hit things, drawn together
+    Particle_system effects_ {effect_capacity};
+    ge211::Circle_batch_sprite effect_batch_ {{width_, height_}};
+
+    // frames drawn so far, for updating the text interface every other
+    // frame
+    unsigned long frames_drawn_ = 0;
+
+    // numbers currently rendered in the text interface
+    int red_lives_shown_ = -1;
+    int blue_lives_shown_ = -1;
+    int red_money_shown_ = -1;
+    int blue_money_shown_ = -1;
+
+    // handles to the sprites retained between frames
+    std::vector<ge211::Sprite_handle> labels_;
+    std::vector<ge211::Sprite_handle> turret_handles_;
+    ge211::Sprite_handle background_handle_;
+    ge211::Sprite_handle interface_layer_handle_;
+    ge211::Sprite_handle interface_backdrop_handle_;
+    ge211::Sprite_handle red_player_handle_;
+    ge211::Sprite_handle blue_player_handle_;
+    ge211::Sprite_handle red_win_handle_;
+    ge211::Sprite_handle blue_win_handle_;
 };
\ No newline at end of file
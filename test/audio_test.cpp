@@ -0,0 +1,68 @@
+#include "disk_audio.h"
+#include <catch.h>
+
+#include <SDL.h>
+
+using namespace ge211;
+
+// Checks the audio thread's timing, and falling back to larger buffers
+// when it runs late.
+
+TEST_CASE("audio callbacks come once per buffer")
+{
+    // 1024 samples at 48 kHz is 21 1/3 ms.
+    Audio_profile profile = Audio_profile::low_latency();
+    profile.buffer_samples = 1024;
+    profile.max_buffer_samples = 1024;
+
+    Audio_test_game game(profile, "21");
+    Mixer* mixer = game.get_mixer();
+    REQUIRE(mixer != nullptr);
+
+    CHECK(mixer->get_profile().buffer_samples == 1024);
+    Duration latency = mixer->get_profile().buffer_latency();
+    CHECK(latency.milliseconds() < 25);
+
+    // Counts callbacks rather than timing them, since a busy machine can
+    // delay any one of them. Being late only makes for fewer callbacks,
+    // so the count can't be more than one per buffer, give or take.
+    Timer waiting;
+    while (mixer->get_audio_stats().callbacks < 20 &&
+           waiting.elapsed_time() < Duration(10)) {
+        SDL_Delay(10);
+    }
+
+    double buffers = waiting.elapsed_time().seconds() / latency.seconds();
+    Audio_stats stats = mixer->get_audio_stats();
+    CHECK(stats.callbacks >= 20);
+    CHECK(stats.callbacks <= 2 * buffers + 2);
+}
+
+TEST_CASE("audio falls back to larger buffers after underruns")
+{
+    Audio_profile profile = Audio_profile::low_latency();
+    profile.buffer_samples = 512;
+    profile.max_buffer_samples = 2048;
+
+    Audio_test_game game(profile, "10");
+    Mixer* mixer = game.get_mixer();
+    REQUIRE(mixer != nullptr);
+    CHECK(mixer->get_profile().buffer_samples == 512);
+
+    // The counts are totals since the device opened, as the audio thread
+    // keeps them. Two underruns since the last check are tolerated.
+    detail::check_mixer_underruns(*mixer, 2);
+    CHECK(mixer->get_profile().buffer_samples == 512);
+
+    // Three more are not.
+    detail::check_mixer_underruns(*mixer, 5);
+    CHECK(mixer->get_profile().buffer_samples == 1024);
+
+    // Reopening the device starts the count again.
+    detail::check_mixer_underruns(*mixer, 3);
+    CHECK(mixer->get_profile().buffer_samples == 2048);
+
+    // And the buffers grow no larger than the profile allows.
+    detail::check_mixer_underruns(*mixer, 100);
+    CHECK(mixer->get_profile().buffer_samples == 2048);
+}
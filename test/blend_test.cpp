@@ -0,0 +1,234 @@
+#include "../.eecs211/lib/ge211/include/ge211_render.h"
+#include <catch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+// Checks the arithmetic behind baked Layer_sprites. The software renderer
+// that Offscreen_renderer uses can't blend premultiplied alpha, so layers
+// there draw their sprites one by one and no rendering test reaches the
+// baked path. Instead, this does on the CPU what the GPU does with the
+// blend modes: it blends the sprites into a transparent texture, stored
+// in eight-bit channels, copies that with the custom blend mode, and
+// compares the result to drawing the sprites directly.
+
+using namespace ge211;
+using namespace ge211::detail;
+
+// A pixel with channels from 0 to 1.
+struct Pixel
+{
+    double red, green, blue, alpha;
+};
+
+static Pixel to_pixel(Color c)
+{
+    return {c.red() / 255.0, c.green() / 255.0,
+            c.blue() / 255.0, c.alpha() / 255.0};
+}
+
+// Rounds to eight bits a channel, as storing in a texture does.
+static Color to_color(Pixel const& p)
+{
+    auto channel = [](double x) {
+        return uint8_t(std::lround(255 * std::min(1.0, std::max(0.0, x))));
+    };
+    return {channel(p.red), channel(p.green),
+            channel(p.blue), channel(p.alpha)};
+}
+
+// SDL_BLENDMODE_BLEND, which sprites are drawn with.
+Blend_equation const ordinary_color{SDL_BLENDFACTOR_SRC_ALPHA,
+                                    SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                                    SDL_BLENDOPERATION_ADD};
+Blend_equation const ordinary_alpha{SDL_BLENDFACTOR_ONE,
+                                    SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA,
+                                    SDL_BLENDOPERATION_ADD};
+
+// What a blend factor multiplies a channel by, given that channel of the
+// source and destination and the two pixels.
+static double factor(SDL_BlendFactor f, double src, double dst,
+                     Pixel const& s, Pixel const& d)
+{
+    switch (f) {
+        case SDL_BLENDFACTOR_ZERO: return 0;
+        case SDL_BLENDFACTOR_ONE: return 1;
+        case SDL_BLENDFACTOR_SRC_COLOR: return src;
+        case SDL_BLENDFACTOR_ONE_MINUS_SRC_COLOR: return 1 - src;
+        case SDL_BLENDFACTOR_SRC_ALPHA: return s.alpha;
+        case SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA: return 1 - s.alpha;
+        case SDL_BLENDFACTOR_DST_COLOR: return dst;
+        case SDL_BLENDFACTOR_ONE_MINUS_DST_COLOR: return 1 - dst;
+        case SDL_BLENDFACTOR_DST_ALPHA: return d.alpha;
+        case SDL_BLENDFACTOR_ONE_MINUS_DST_ALPHA: return 1 - d.alpha;
+    }
+    FAIL("unknown blend factor");
+    return 0;
+}
+
+static double channel(Blend_equation const& e, double src, double dst,
+                      Pixel const& s, Pixel const& d)
+{
+    double a = src * factor(e.source, src, dst, s, d);
+    double b = dst * factor(e.destination, src, dst, s, d);
+
+    switch (e.operation) {
+        case SDL_BLENDOPERATION_ADD: return a + b;
+        case SDL_BLENDOPERATION_SUBTRACT: return a - b;
+        case SDL_BLENDOPERATION_REV_SUBTRACT: return b - a;
+        case SDL_BLENDOPERATION_MINIMUM: return std::min(src, dst);
+        case SDL_BLENDOPERATION_MAXIMUM: return std::max(src, dst);
+    }
+    FAIL("unknown blend operation");
+    return 0;
+}
+
+// Draws `s` over `d` the way the GPU does with a blend mode made from the
+// two equations.
+static Pixel blend(Blend_equation const& color, Blend_equation const& alpha,
+                   Pixel const& s, Pixel const& d)
+{
+    return {channel(color, s.red, d.red, s, d),
+            channel(color, s.green, d.green, s, d),
+            channel(color, s.blue, d.blue, s, d),
+            channel(alpha, s.alpha, d.alpha, s, d)};
+}
+
+static Pixel blend_ordinary(Pixel const& s, Pixel const& d)
+{
+    return blend(ordinary_color, ordinary_alpha, s, d);
+}
+
+// Scales a texel by a texture's color and alpha modulation, as SDL does
+// before blending.
+static Pixel modulate(Pixel const& p, Color color_mod, uint8_t alpha_mod)
+{
+    return {p.red * color_mod.red() / 255,
+            p.green * color_mod.green() / 255,
+            p.blue * color_mod.blue() / 255,
+            p.alpha * alpha_mod / 255};
+}
+
+// Blends the sprites into a transparent texture, as Layer_sprite bakes
+// them.
+static Color bake(std::vector<Color> const& sprites)
+{
+    Pixel texel{0, 0, 0, 0};
+    for (Color sprite : sprites)
+        texel = to_pixel(to_color(blend_ordinary(to_pixel(sprite), texel)));
+    return to_color(texel);
+}
+
+// Copies a baked texel onto `under` with the given tint, as drawing the
+// layer does.
+static Color copy_baked(Color texel, Color under, Color tint)
+{
+    Pixel source = modulate(to_pixel(texel), premultiplied_tint(tint),
+                            tint.alpha());
+    Blend_equation const& e = premultiplied_blend;
+    return to_color(blend(e, e, source, to_pixel(under)));
+}
+
+// Draws the sprites onto `under` one at a time.
+static Color draw_directly(std::vector<Color> const& sprites, Color under)
+{
+    Pixel result = to_pixel(under);
+    for (Color sprite : sprites)
+        result = to_pixel(to_color(blend_ordinary(to_pixel(sprite), result)));
+    return to_color(result);
+}
+
+static int difference(Color a, Color b)
+{
+    return std::max({std::abs(a.red() - b.red()),
+                     std::abs(a.green() - b.green()),
+                     std::abs(a.blue() - b.blue()),
+                     std::abs(a.alpha() - b.alpha())});
+}
+
+// Opaque, translucent, nearly clear, and clear sprites.
+Color const sprite_colors[] = {
+        {200, 100, 50, 255},
+        {255, 255, 255, 128},
+        {0, 64, 255, 200},
+        {10, 200, 30, 1},
+        {255, 0, 0, 0},
+        {128, 128, 128, 64},
+};
+
+Color const backgrounds[] = {
+        Color::black(),
+        Color::white(),
+        {40, 90, 160},
+        {0, 0, 0, 0},
+};
+
+// Eight-bit channels round at every step; let each be off by two.
+int const tolerance = 2;
+
+TEST_CASE("a baked layer copies like its sprites drawn directly")
+{
+    int mismatches = 0;
+
+    for (Color under : backgrounds) {
+        for (Color first : sprite_colors) {
+            for (Color second : sprite_colors) {
+                std::vector<Color> layer{first, second};
+                Color baked = copy_baked(bake(layer), under,
+                                         Color::white());
+                Color direct = draw_directly(layer, under);
+                if (difference(baked, direct) > tolerance) ++mismatches;
+            }
+        }
+    }
+
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("a tinted layer fades and tints as a whole")
+{
+    Color const tints[] = {
+            {255, 255, 255, 128},
+            {255, 128, 0, 255},
+            {0, 255, 255, 64},
+            {255, 255, 255, 0},
+    };
+
+    int mismatches = 0;
+
+    for (Color under : backgrounds) {
+        for (Color tint : tints) {
+            for (Color sprite : sprite_colors) {
+                // Tinting the layer is tinting what it shows: its color
+                // times the tint, covering as much as both alphas allow.
+                Color expected = to_color(blend_ordinary(
+                        modulate(to_pixel(sprite), tint, tint.alpha()),
+                        to_pixel(under)));
+
+                Color baked = copy_baked(bake({sprite}), under, tint);
+                if (difference(baked, expected) > tolerance) ++mismatches;
+            }
+        }
+    }
+
+    CHECK(mismatches == 0);
+}
+
+TEST_CASE("the ordinary blend would darken a baked layer's edges")
+{
+    // This is why target textures have their own blend mode: copying a
+    // half-transparent white with the ordinary one multiplies it by its
+    // alpha a second time.
+    Color const edge{255, 255, 255, 128};
+    Color const under = Color::black();
+
+    Color texel = bake({edge});
+    Color ordinary = to_color(blend_ordinary(to_pixel(texel),
+                                             to_pixel(under)));
+
+    CHECK(difference(copy_baked(texel, under, Color::white()),
+                     draw_directly({edge}, under)) <= tolerance);
+    CHECK(difference(ordinary, draw_directly({edge}, under)) > tolerance);
+}
@@ -0,0 +1,89 @@
+#include "../.eecs211/lib/ge211/include/ge211_camera.h"
+#include <catch.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace ge211;
+
+TEST_CASE("a new camera shows the world as it is")
+{
+    Camera camera({0, 0, 800, 400});
+
+    CHECK(camera.visible_area() == Rectangle{0, 0, 800, 400});
+    CHECK(camera.to_screen({123, 45}) == Position{123, 45});
+    CHECK(camera.to_world({123, 45}) == Position{123, 45});
+    CHECK(camera.transform() == Transform{});
+}
+
+TEST_CASE("zooming in shows less of the world, bigger")
+{
+    Camera camera({0, 0, 800, 400});
+    camera.set_zoom(2);
+
+    CHECK(camera.visible_area() == Rectangle{200, 100, 400, 200});
+    CHECK(camera.to_screen({200, 100}) == Position{0, 0});
+    CHECK(camera.to_screen({300, 150}) == Position{200, 100});
+    CHECK(camera.to_world({200, 100}) == Position{300, 150});
+    CHECK(camera.can_see({590, 290, 20, 20}));
+    CHECK_FALSE(camera.can_see({600, 300, 20, 20}));
+
+    CHECK_THROWS_AS(camera.set_zoom(0), Client_logic_error);
+}
+
+TEST_CASE("the camera can be kept within the world")
+{
+    Camera camera({0, 0, 800, 400});
+    camera.set_zoom(2).set_center({10, 390}).keep_within({0, 0, 800, 400});
+    CHECK(camera.visible_area() == Rectangle{0, 200, 400, 200});
+
+    camera.set_zoom(1).pan({50, 50}).keep_within({0, 0, 800, 400});
+    CHECK(camera.visible_area() == Rectangle{0, 0, 800, 400});
+}
+
+TEST_CASE("a viewport below the top of the window")
+{
+    Camera camera({0, 100, 800, 400});
+    camera.set_center({1000, 1000});
+
+    CHECK(camera.to_screen({600, 800}) == Position{0, 100});
+    CHECK(camera.to_world({0, 100}) == Position{600, 800});
+}
+
+TEST_CASE("the grid finds the same rectangles as testing them all")
+{
+    Rectangle const world{0, 0, 1000, 600};
+    Spatial_grid<size_t> grid(world, 64);
+    std::vector<Rectangle> rects;
+
+    // Some span several cells, and some are partly or wholly outside.
+    for (int i = 0; i < 2000; ++i) {
+        rects.push_back({(i * 37) % 1100 - 50, (i * 53) % 700 - 50,
+                         1 + (i * 7) % 150, 1 + (i * 11) % 90});
+        grid.insert(rects.back(), rects.size() - 1);
+    }
+    CHECK(grid.size() == rects.size());
+
+    for (Rectangle area : {Rectangle{0, 0, 1000, 600},
+                           Rectangle{100, 100, 300, 200},
+                           Rectangle{-100, 550, 300, 200},
+                           Rectangle{640, 64, 1, 1},
+                           Rectangle{2000, 2000, 10, 10}}) {
+        std::vector<size_t> found;
+        grid.query(area, [&](size_t i) { found.push_back(i); });
+        std::sort(found.begin(), found.end());
+
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < rects.size(); ++i)
+            if (overlap(rects[i], area)) expected.push_back(i);
+
+        INFO(area.x << ", " << area.y << ", "
+                    << area.width << ", " << area.height);
+        CHECK(found == expected);
+    }
+
+    grid.clear();
+    size_t count = 0;
+    grid.query(world, [&](size_t) { ++count; });
+    CHECK(count == 0);
+}
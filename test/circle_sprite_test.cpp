@@ -0,0 +1,122 @@
+#include "../.eecs211/lib/ge211/include/ge211_offscreen.h"
+#include <catch.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+
+// Checks that Circle_sprite, which fills a row at a time, draws the same
+// pixels as the old loop that set them one at a time, and that smooth
+// edges are only partly transparent where the circle crosses the pixel.
+
+using namespace ge211;
+
+// Odd and even sizes, small ones where rounding matters most, and a large
+// one.
+int const radii[] = {1, 2, 3, 4, 5, 8, 15, 16, 61, 100};
+
+// Renders the circle, which is 2 * radius pixels across, on black.
+static Rgba_image render(Circle_sprite const& circle, int radius)
+{
+    Offscreen_renderer offscreen({2 * radius, 2 * radius});
+    offscreen.render([&](Sprite_set& sprites) {
+        sprites.add_sprite(circle, {0, 0});
+    });
+    return offscreen.snapshot();
+}
+
+// Which pixels the circle covered when Circle_sprite set them one at a
+// time, before it filled rows, as a 2 * radius by 2 * radius grid.
+static std::vector<bool> covered_one_pixel_at_a_time(int radius)
+{
+    int const width = 2 * radius;
+    std::vector<bool> covered(size_t(width) * width, false);
+
+    auto set_pixel = [&](int x, int y) {
+        covered[size_t(y) * width + x] = true;
+    };
+
+    for (int y = 0; y < radius; ++y) {
+        for (int x = 0; x < radius; ++x) {
+            if (x * x + y * y < radius * radius) {
+                set_pixel(radius + x, radius + y);
+                set_pixel(radius + x, radius - y - 1);
+                set_pixel(radius - x - 1, radius + y);
+                set_pixel(radius - x - 1, radius - y - 1);
+            }
+        }
+    }
+
+    return covered;
+}
+
+TEST_CASE("circles need a positive radius")
+{
+    CHECK_THROWS_AS(Circle_sprite(0), exceptions::Client_logic_error);
+    CHECK_THROWS_AS(Circle_sprite(-1), exceptions::Client_logic_error);
+    CHECK_THROWS_AS(Circle_sprite(0, Color::white(),
+                                  Circle_sprite::Edge::smooth),
+                    exceptions::Client_logic_error);
+}
+
+TEST_CASE("sharp circles cover the same pixels as before")
+{
+    Color const color{200, 100, 50};
+
+    for (int radius : radii) {
+        Rgba_image image = render(Circle_sprite(radius, color), radius);
+        std::vector<bool> covered = covered_one_pixel_at_a_time(radius);
+
+        int const width = 2 * radius;
+        int mismatches = 0;
+        for (int y = 0; y < width; ++y) {
+            for (int x = 0; x < width; ++x) {
+                Color expected = covered[size_t(y) * width + x]
+                                 ? color : Color::black();
+                if (image.get_pixel({x, y}) != expected) ++mismatches;
+            }
+        }
+
+        INFO("radius " << radius);
+        CHECK(mismatches == 0);
+    }
+}
+
+TEST_CASE("smooth circles are partly transparent only along the edge")
+{
+    for (int radius : radii) {
+        // White on black, so each pixel's red is the circle's alpha there.
+        Rgba_image image = render(
+                Circle_sprite(radius, Color::white(),
+                              Circle_sprite::Edge::smooth),
+                radius);
+
+        int const width = 2 * radius;
+        int mismatches = 0;
+        int partial = 0;
+        double area = 0;
+
+        for (int y = 0; y < width; ++y) {
+            for (int x = 0; x < width; ++x) {
+                int alpha = image.get_pixel({x, y}).red();
+                area += alpha / 255.0;
+                if (alpha > 0 && alpha < 255) ++partial;
+
+                // Pixels whose centers are within radius - 1/2 are opaque,
+                // those beyond radius + 1/2 clear, and in between the alpha
+                // falls off with the distance. Blending may round by one.
+                double distance = std::hypot(x + 0.5 - radius,
+                                             y + 0.5 - radius);
+                double coverage = std::min(1.0, std::max(
+                        0.0, radius + 0.5 - distance));
+                if (std::abs(alpha - 255 * coverage) > 1.5) ++mismatches;
+            }
+        }
+
+        INFO("radius " << radius);
+        CHECK(mismatches == 0);
+        CHECK(partial > 0);
+        CHECK(area == Approx(3.14159265 * radius * radius).epsilon(0.05));
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <ge211.h>
+
+#include <SDL.h>
+
+// The audio tests use SDL's disk audio driver, which writes the sound to
+// a file (here, nowhere) and then waits SDL_DISKAUDIODELAY milliseconds
+// before asking for the next buffer, the way a sound card would. So they
+// need neither a sound card nor a display.
+
+// Chooses the drivers before the game starts SDL, and returns the profile
+// to open the mixer with. If `delay_ms` is given, the device takes that
+// long over each buffer; otherwise the delay stays as it was.
+inline const ge211::Audio_profile&
+use_disk_audio(const ge211::Audio_profile& profile,
+               const char* delay_ms = nullptr)
+{
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+    SDL_setenv("SDL_AUDIODRIVER", "disk", 1);
+    SDL_setenv("SDL_DISKAUDIOFILE", "/dev/null", 1);
+    if (delay_ms) SDL_setenv("SDL_DISKAUDIODELAY", delay_ms, 1);
+    return profile;
+}
+
+// A game that does nothing but open the mixer on the disk driver.
+struct Audio_test_game : ge211::Abstract_game
+{
+    explicit Audio_test_game(
+            const ge211::Audio_profile& profile =
+                    ge211::Audio_profile::standard(),
+            const char* delay_ms = nullptr)
+            : Abstract_game(use_disk_audio(profile, delay_ms))
+    { }
+
+    using Abstract_game::get_mixer;
+
+    void draw(ge211::Sprite_set&) override
+    { }
+};
@@ -0,0 +1,86 @@
+#include "../.eecs211/lib/ge211/include/ge211_offscreen.h"
+#include <catch.h>
+
+// Checks that the kinds of sprite the draw call benchmark measures
+// (ge211/examples/draw_call_bench.cpp) render what they should when
+// there are many of them in one frame.
+
+using namespace ge211;
+
+int const draw_count = 2000;
+
+Dimensions const screen{200, 200};
+
+// Spreads the sprites over the screen.
+static Position place(int i)
+{
+    return {i * 7 % (screen.width - 8), i * 13 % (screen.height - 8)};
+}
+
+// Renders `draw_count` sprites with `add` and returns the frame.
+template <class ADD>
+static Rgba_image render(ADD add)
+{
+    Offscreen_renderer offscreen(screen);
+    offscreen.render([&](Sprite_set& sprites) {
+        sprites.reserve(draw_count);
+        for (int i = 0; i < draw_count; ++i)
+            add(sprites, i);
+    });
+    return offscreen.snapshot();
+}
+
+TEST_CASE("many sprites with their own texture")
+{
+    Rectangle_sprite square{{4, 4}, Color{0, 200, 0}};
+
+    Rgba_image frame = render([&](Sprite_set& sprites, int i) {
+        sprites.add_sprite(square, place(i));
+    });
+
+    CHECK(frame.get_pixel(place(0)) == Color(0, 200, 0));
+}
+
+TEST_CASE("many regions of an atlas")
+{
+    Rectangle_sprite red{{4, 4}, Color{200, 0, 0}};
+    Rectangle_sprite blue{{4, 4}, Color{0, 0, 200}};
+    Sprite_atlas atlas;
+    atlas.pack(red);
+    atlas.pack(blue);
+
+    Rgba_image frame = render([&](Sprite_set& sprites, int i) {
+        sprites.add_sprite(i % 2 ? blue : red, place(i));
+    });
+
+    CHECK(frame.get_pixel(place(draw_count - 1)) ==
+          ((draw_count - 1) % 2 ? Color(0, 0, 200) : Color(200, 0, 0)));
+}
+
+TEST_CASE("many tinted sprites")
+{
+    Rectangle_sprite white{{4, 4}};
+    Transform const tint = Transform::tint(Color{0, 0, 200});
+
+    Rgba_image frame = render([&](Sprite_set& sprites, int i) {
+        sprites.add_sprite(white, place(i), 0, tint);
+    });
+
+    CHECK(frame.get_pixel(place(draw_count - 1)) == Color(0, 0, 200));
+}
+
+TEST_CASE("many scaled sprites")
+{
+    Rectangle_sprite white{{4, 4}};
+    Transform const scale = Transform::scale(2);
+
+    Rgba_image frame = render([&](Sprite_set& sprites, int i) {
+        sprites.add_sprite(white, place(i), 0, scale);
+    });
+
+    // Only the last sprite is sure to be on top, and scaled it covers
+    // 8 by 8 pixels.
+    Position last = place(draw_count - 1);
+    CHECK(frame.get_pixel(last) == Color::white());
+    CHECK(frame.get_pixel(last + Dimensions{7, 7}) == Color::white());
+}
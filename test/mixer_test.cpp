@@ -0,0 +1,165 @@
+#include "disk_audio.h"
+#include <catch.h>
+
+#include <SDL.h>
+
+#include <vector>
+
+using namespace ge211;
+
+// Checks how the Mixer shares its effect channels: the per-frame rate
+// limit, which effect a full mixer replaces, and getting channels back
+// from effects that finish.
+
+// An effect of `length` of silence in the mixer's format.
+static Sound_effect silence(const Mixer& mixer, Duration length)
+{
+    const Audio_profile& profile = mixer.get_profile();
+    int sample_bytes =
+            profile.format == Audio_profile::Format::int16 ? 2 : 4;
+    size_t bytes = size_t(length.seconds() * profile.frequency) *
+                   size_t(profile.channels * sample_bytes);
+    return Sound_effect(std::vector<uint8_t>(bytes), mixer);
+}
+
+// Ends a frame the way the engine does.
+static void end_frame(Mixer& mixer)
+{
+    detail::poll_mixer(mixer);
+}
+
+// Long enough that nothing finishes during a test unless it is meant to.
+Duration const long_effect{10};
+
+TEST_CASE("effects from samples hold whole frames")
+{
+    Audio_test_game game;
+    Mixer* mixer = game.get_mixer();
+    REQUIRE(mixer != nullptr);
+
+    CHECK(silence(*mixer, Duration(0.1)));
+    CHECK_THROWS_AS(Sound_effect(std::vector<uint8_t>(1), *mixer),
+                    Client_logic_error);
+}
+
+TEST_CASE("the same effect starts at most so many times a frame")
+{
+    Audio_test_game game;
+    Mixer* mixer = game.get_mixer();
+    REQUIRE(mixer != nullptr);
+
+    Sound_effect hit = silence(*mixer, long_effect);
+    Sound_effect bounce = silence(*mixer, long_effect);
+    REQUIRE(hit);
+    REQUIRE(bounce);
+
+    REQUIRE(mixer->get_effect_rate_limit() == 2);
+    CHECK(mixer->play_effect(hit));
+    CHECK(mixer->play_effect(hit));
+    CHECK_FALSE(mixer->play_effect(hit));
+    CHECK(mixer->play_effect(bounce));
+
+    end_frame(*mixer);
+    CHECK(mixer->play_effect(hit));
+
+    mixer->set_effect_rate_limit(0);
+    CHECK(mixer->play_effect(hit));
+    CHECK(mixer->play_effect(hit));
+
+    CHECK_THROWS_AS(mixer->set_effect_rate_limit(-1), Client_logic_error);
+}
+
+TEST_CASE("a full mixer replaces the quietest effect, then the oldest")
+{
+    Audio_test_game game;
+    Mixer* mixer = game.get_mixer();
+    REQUIRE(mixer != nullptr);
+    mixer->set_effect_rate_limit(0);
+
+    Sound_effect effect = silence(*mixer, long_effect);
+    int const channel_count = mixer->available_effect_channels();
+    REQUIRE(channel_count >= 3);
+
+    // The first is loud and the rest quiet.
+    std::vector<Sound_effect_handle> playing;
+    for (int i = 0; i < channel_count; ++i)
+        playing.push_back(mixer->play_effect(effect, i == 0 ? 1.0 : 0.5));
+    CHECK(mixer->available_effect_channels() == 0);
+
+    Sound_effect_handle first = mixer->play_effect(effect);
+    REQUIRE(first);
+    CHECK(playing[0].get_state() == Mixer::State::playing);
+    CHECK(playing[1].get_state() == Mixer::State::detached);
+    CHECK(playing[2].get_state() == Mixer::State::playing);
+
+    Sound_effect_handle second = mixer->play_effect(effect);
+    REQUIRE(second);
+    CHECK(playing[0].get_state() == Mixer::State::playing);
+    CHECK(playing[2].get_state() == Mixer::State::detached);
+    CHECK(first.get_state() == Mixer::State::playing);
+    CHECK(mixer->available_effect_channels() == 0);
+}
+
+TEST_CASE("effects of higher priority are not replaced")
+{
+    Audio_test_game game;
+    Mixer* mixer = game.get_mixer();
+    REQUIRE(mixer != nullptr);
+    mixer->set_effect_rate_limit(0);
+
+    Sound_effect effect = silence(*mixer, long_effect);
+    int const channel_count = mixer->available_effect_channels();
+    REQUIRE(channel_count >= 2);
+
+    // The first has low priority, though it is the loudest, and the rest
+    // high priority.
+    std::vector<Sound_effect_handle> playing;
+    for (int i = 0; i < channel_count; ++i) {
+        playing.push_back(i == 0 ? mixer->play_effect(effect, 1.0, 0)
+                                 : mixer->play_effect(effect, 0.1, 1));
+    }
+
+    CHECK(mixer->play_effect(effect, 0.1, 1));
+    CHECK(playing[0].get_state() == Mixer::State::detached);
+
+    CHECK_FALSE(mixer->play_effect(effect, 1.0, 0));
+    for (int i = 1; i < channel_count; ++i)
+        CHECK(playing[i].get_state() == Mixer::State::playing);
+
+    CHECK(mixer->play_effect(effect, 1.0, 2));
+    CHECK(playing[1].get_state() == Mixer::State::detached);
+}
+
+TEST_CASE("finished effects give back their channels")
+{
+    Audio_test_game game;
+    Mixer* mixer = game.get_mixer();
+    REQUIRE(mixer != nullptr);
+
+    int const channel_count = mixer->available_effect_channels();
+
+    Sound_effect_handle short_one =
+            mixer->play_effect(silence(*mixer, Duration(0.02)));
+    Sound_effect_handle long_one =
+            mixer->play_effect(silence(*mixer, long_effect));
+    REQUIRE(short_one);
+    REQUIRE(long_one);
+    CHECK(mixer->available_effect_channels() == channel_count - 2);
+
+    // The audio thread reports the short one finished, and the next frame
+    // takes its channel back.
+    Timer waiting;
+    while (mixer->available_effect_channels() < channel_count - 1 &&
+           waiting.elapsed_time() < Duration(10)) {
+        SDL_Delay(10);
+        end_frame(*mixer);
+    }
+
+    CHECK(mixer->available_effect_channels() == channel_count - 1);
+    CHECK(short_one.get_state() == Mixer::State::detached);
+    CHECK(long_one.get_state() == Mixer::State::playing);
+
+    long_one.stop();
+    CHECK(long_one.get_state() == Mixer::State::detached);
+    CHECK(mixer->available_effect_channels() == channel_count);
+}
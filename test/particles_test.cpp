@@ -0,0 +1,124 @@
+#include "particles.h"
+#include "../.eecs211/lib/ge211/include/ge211_camera.h"
+#include "../.eecs211/lib/ge211/include/ge211_sprites.h"
+#include <catch.h>
+
+#include <cmath>
+
+// Checks the particle pool. For how long moving and drawing a full pool
+// takes, see bench/particle_bench.cpp.
+
+using namespace ge211;
+
+size_t const particle_count = 100000;
+
+Dimensions const screen{800, 400};
+
+static Burst burst(Position center, int count, float lifetime = 1)
+{
+    return {center, count, 50, 100, lifetime, Color::medium_red()};
+}
+
+TEST_CASE("bursts come out smaller when the pool is full")
+{
+    Particle_system particles(100);
+
+    CHECK(particles.emit(burst({10, 10}, 60)) == 60);
+    CHECK(particles.emit(burst({10, 10}, 60)) == 40);
+    CHECK(particles.emit(burst({10, 10}, 60)) == 0);
+    CHECK(particles.size() == 100);
+
+    particles.clear();
+    CHECK(particles.emit(burst({10, 10}, -5)) == 0);
+    CHECK(particles.emit(burst({10, 10}, 60)) == 60);
+}
+
+TEST_CASE("particles burn out, making room for more")
+{
+    Particle_system particles(100);
+    particles.emit(burst({10, 10}, 50, 0.5f));
+    particles.emit(burst({10, 10}, 50, 1.5f));
+
+    particles.update(1);
+    CHECK(particles.size() == 50);
+    CHECK(particles.emit(burst({10, 10}, 60, 3)) == 50);
+
+    particles.update(1);
+    CHECK(particles.size() == 50);
+}
+
+TEST_CASE("burned-out particles make way for the live ones after them")
+{
+    // Short- and long-lived particles alternate in the pool, far apart.
+    Particle_system particles(100);
+    for (int i = 0; i < 50; ++i) {
+        particles.emit(burst({100, 200}, 1, 0.5f));
+        particles.emit(burst({600, 200}, 1, 3));
+    }
+
+    particles.update(1);
+    REQUIRE(particles.size() == 50);
+
+    // Counts the particles within 100 pixels of (x, y).
+    auto count_near = [&](double x, double y) {
+        Camera camera({0, 0, 200, 200});
+        camera.set_center({x, y});
+        Circle_batch_sprite batch({200, 200});
+        particles.draw(batch, camera, 1);
+        return batch.size();
+    };
+
+    CHECK(count_near(100, 200) == 0);
+    CHECK(count_near(600, 200) == 50);
+}
+
+TEST_CASE("particles fly outward and slow down")
+{
+    Particle_system particles(1000);
+    particles.emit(burst({400, 200}, 1000, 10));
+
+    // Counts the particles less than `half` from where they started,
+    // horizontally and vertically.
+    auto count_within = [&](double half) {
+        Camera camera({0, 0, 200, 200});
+        camera.set_center({400, 200}).set_zoom(100 / half);
+        Circle_batch_sprite batch({200, 200});
+        particles.draw(batch, camera, 1);
+        return batch.size();
+    };
+
+    double const drag = Particle_system::drag;
+    double elapsed = 0;
+
+    // Slowing down, a particle starting at 50 to 100 px/s gets 50 to 100
+    // times this far in t seconds, however the time is divided up.
+    for (double dt : {0.25, 0.25, 0.5, 1.0}) {
+        particles.update(dt);
+        elapsed += dt;
+
+        double covered = (1 - std::pow(drag, elapsed)) / std::log(1 / drag);
+        INFO("after " << elapsed << " s");
+        CHECK(count_within(50 * covered / std::sqrt(2) - 2) == 0);
+        CHECK(count_within(100 * covered + 2) == 1000);
+    }
+}
+
+TEST_CASE("a full pool keeps every live particle")
+{
+    Camera camera({0, 0, screen.width, screen.height});
+    Circle_batch_sprite batch(screen);
+
+    Particle_system particles(particle_count);
+    for (int i = 0; i < 250; ++i) {
+        Position center{i * 37 % screen.width, i * 53 % screen.height};
+        particles.emit(burst(center, 400, 100));
+    }
+    CHECK(particles.size() == particle_count);
+
+    for (int frame = 0; frame < 10; ++frame)
+        particles.update(1 / 60.0);
+
+    particles.draw(batch, camera, 1);
+    CHECK(particles.size() == particle_count);
+    CHECK(batch.size() > particle_count / 2);
+}
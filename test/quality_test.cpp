@@ -0,0 +1,128 @@
+#include "quality.h"
+#include <catch.h>
+
+using ge211::Duration;
+
+// a budget of 10 ms, so the marks are at 9 ms and 6 ms
+static Duration const budget(0.010);
+
+static Duration ms(double milliseconds)
+{
+    return Duration(milliseconds / 1000);
+}
+
+// Records the same frame time n times, returning how many times the
+// level changed.
+static int record(Quality_governor& governor, Duration busy, int n)
+{
+    int changes = 0;
+    for (int i = 0; i < n; ++i) {
+        if (governor.record_frame(busy)) ++changes;
+    }
+    return changes;
+}
+
+TEST_CASE("frames within budget keep full quality")
+{
+    Quality_governor governor(budget);
+    CHECK(record(governor, ms(5), 1000) == 0);
+    CHECK(governor.level() == Quality::full);
+}
+
+TEST_CASE("slow frames step the quality down one level at a time")
+{
+    Quality_governor governor(budget);
+
+    record(governor, ms(15), Quality_governor::down_hold - 1);
+    CHECK(governor.level() == Quality::full);
+
+    record(governor, ms(15), 1);
+    CHECK(governor.level() == Quality::fewer_particles);
+
+    record(governor, ms(15), Quality_governor::down_hold);
+    CHECK(governor.level() == Quality::plain_text);
+
+    record(governor, ms(15), 100 * Quality_governor::down_hold);
+    CHECK(governor.level() == Quality::point_balls);
+}
+
+TEST_CASE("a single slow frame doesn't change the quality")
+{
+    Quality_governor governor(budget);
+    record(governor, ms(5), 100);
+    record(governor, ms(30), 1);
+    CHECK(record(governor, ms(5), 100) == 0);
+    CHECK(governor.level() == Quality::full);
+}
+
+TEST_CASE("one step that is enough is the only step")
+{
+    Quality_governor governor(budget);
+
+    // twice the budget until the first step, then half of it
+    int changes = record(governor, ms(20), Quality_governor::down_hold);
+    changes += record(governor, ms(5), 100);
+
+    CHECK(changes == 1);
+    CHECK(governor.level() == Quality::fewer_particles);
+}
+
+TEST_CASE("frames between the marks keep the quality where it is")
+{
+    Quality_governor governor(budget);
+    record(governor, ms(15), 2 * Quality_governor::down_hold);
+    Quality level = governor.level();
+    CHECK(level != Quality::full);
+
+    CHECK(record(governor, ms(7.5), 10 * Quality_governor::max_up_hold) == 0);
+    CHECK(governor.level() == level);
+}
+
+TEST_CASE("the quality comes back only after a long stretch of fast frames")
+{
+    Quality_governor governor(budget);
+    record(governor, ms(15), Quality_governor::down_hold);
+    CHECK(governor.level() == Quality::fewer_particles);
+
+    record(governor, ms(2), Quality_governor::up_hold / 2);
+    CHECK(governor.level() == Quality::fewer_particles);
+
+    record(governor, ms(2), Quality_governor::up_hold);
+    CHECK(governor.level() == Quality::full);
+}
+
+TEST_CASE("a step up that doesn't fit makes the next one wait longer")
+{
+    Quality_governor governor(budget);
+
+    // full quality is too slow, but the next level has room to spare
+    auto cost = [&] {
+        return ms(governor.level() == Quality::full ? 12 : 4);
+    };
+
+    auto run = [&](int frames) {
+        int changes = 0;
+        for (int i = 0; i < frames; ++i) {
+            if (governor.record_frame(cost())) ++changes;
+        }
+        return changes;
+    };
+
+    // it settles one level down, trying to go back up less and less
+    // often
+    run(200);
+    CHECK(governor.level() == Quality::fewer_particles);
+
+    int early = run(2000);
+    int late = run(2000);
+    CHECK(early > late);
+    CHECK(late <= 4);
+}
+
+TEST_CASE("fewer particles are drawn at lower quality")
+{
+    CHECK(particle_share(Quality::full) == 1);
+    CHECK(particle_share(Quality::fewer_particles) < 1);
+    CHECK(particle_share(Quality::point_balls) ==
+          particle_share(Quality::fewer_particles));
+}
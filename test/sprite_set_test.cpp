@@ -0,0 +1,116 @@
+#include "../.eecs211/lib/ge211/include/ge211_offscreen.h"
+#include <catch.h>
+
+#include <algorithm>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Checks that building sprites in parallel gives the same frame as
+// building them on one thread. For how long it takes, see
+// ge211/examples/parallel_build_bench.cpp.
+
+using namespace ge211;
+
+size_t const sprite_count = 20000;
+
+Dimensions const screen{400, 300};
+
+// Sprites of different colors that overlap, so that the frame shows
+// whether they were added in the right order.
+struct Scene
+{
+    Rectangle_sprite squares[3]{
+            Rectangle_sprite{{8, 8}, Color::medium_red()},
+            Rectangle_sprite{{8, 8}, Color::medium_green()},
+            Rectangle_sprite{{8, 8}, Color::medium_blue()},
+    };
+
+    void build(Sprite_list& list, size_t begin, size_t end) const
+    {
+        for (size_t i = begin; i < end; ++i) {
+            // Every seventh entity has nothing to draw, as for a ball that
+            // has left the arena.
+            if (i % 7 == 0) continue;
+
+            Position position{int(i * 37 % (screen.width - 8)),
+                              int(i * 53 % (screen.height - 8))};
+            list.add_sprite(squares[i % 3], position, int(i % 2));
+        }
+    }
+};
+
+// Renders the scene built on the given number of threads.
+static void render_scene(Offscreen_renderer& offscreen, Scene const& scene,
+                         unsigned thread_count)
+{
+    auto build = [&](Sprite_list& list, size_t begin, size_t end) {
+        scene.build(list, begin, end);
+    };
+
+    offscreen.render([&](Sprite_set& sprites) {
+        sprites.reserve(sprite_count);
+        sprites.add_parallel(sprite_count, thread_count, build);
+    });
+}
+
+TEST_CASE("sprites built in parallel render the same as in order")
+{
+    Offscreen_renderer offscreen(screen);
+    Scene scene;
+
+    offscreen.render([&](Sprite_set& sprites) {
+        Sprite_list list;
+        list.reserve(sprite_count);
+        scene.build(list, 0, sprite_count);
+        sprites.add_sprites(list);
+        CHECK(list.size() == 0);
+    });
+    Rgba_image expected = offscreen.snapshot();
+
+    for (unsigned threads = 1; threads <= 8; ++threads) {
+        render_scene(offscreen, scene, threads);
+
+        INFO(threads << " threads");
+        CHECK(offscreen.snapshot().pixels == expected.pixels);
+    }
+}
+
+TEST_CASE("a few entities on many threads")
+{
+    Offscreen_renderer offscreen(screen);
+    std::mutex mutex;
+    std::vector<std::pair<size_t, size_t>> ranges;
+
+    // Catch isn't thread safe, so the ranges are checked afterward.
+    offscreen.render([&](Sprite_set& sprites) {
+        sprites.add_parallel(3, 8, [&](Sprite_list&, size_t begin,
+                                       size_t end) {
+            std::lock_guard<std::mutex> lock(mutex);
+            ranges.emplace_back(begin, end);
+        });
+    });
+
+    std::sort(ranges.begin(), ranges.end());
+    CHECK(ranges == (std::vector<std::pair<size_t, size_t>>{
+            {0, 1}, {1, 2}, {2, 3}}));
+}
+
+TEST_CASE("an exception while building sprites is rethrown")
+{
+    Offscreen_renderer offscreen(screen);
+    Scene scene;
+
+    offscreen.render([&](Sprite_set& sprites) {
+        auto build = [&](Sprite_list& list, size_t begin, size_t end) {
+            scene.build(list, begin, end);
+            if (begin > 0) throw std::runtime_error("oops");
+        };
+
+        CHECK_THROWS_AS(sprites.add_parallel(1000, 4, build),
+                        std::runtime_error);
+        CHECK_THROWS_AS(sprites.add_parallel(1000, 0, build),
+                        exceptions::Client_logic_error);
+    });
+}
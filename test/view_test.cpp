@@ -0,0 +1,163 @@
+#include "model.h"
+#include "view.h"
+#include "../.eecs211/lib/ge211/include/ge211_offscreen.h"
+#include <catch.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+// Renders the view in fixed scenarios, offscreen, and compares each frame
+// to a golden image in test/golden, so that changes to how the view or
+// the engine renders can't change what ends up on the screen unnoticed.
+//
+// A missing golden image fails the test. To make the golden images, or to
+// replace them after an intended change, set GE211_UPDATE_GOLDEN in the
+// environment, and the test saves each frame as the new golden image
+// instead of comparing. Look at them before committing them! When a frame
+// doesn't match, or has no golden image, the test saves it as
+// <scenario>.actual.png in the working directory.
+
+using namespace ge211;
+
+// How far each channel of a pixel may be from the golden image, to allow
+// for small differences in how SDL blends and how fonts are rasterized.
+int const channel_tolerance = 8;
+
+// Model befriends Test_access, which lets a test set up scenarios that
+// would take many frames to reach by playing.
+class Test_access
+{
+public:
+    explicit Test_access(Model& model)
+            : model_(model)
+    { }
+
+    std::vector<Ball>& balls()
+    {
+        return model_.list_of_balls_;
+    }
+
+    std::vector<Turret>& turrets()
+    {
+        return model_.list_of_turrets_;
+    }
+
+private:
+    Model& model_;
+};
+
+// Renders a scenario and checks it against its golden image.
+static void check_scenario(std::string const& name, Model& model)
+{
+    // The offscreen renderer starts SDL, so it must exist before the view,
+    // which starts loading its fonts right away.
+    Offscreen_renderer offscreen({width_, height_ + 100});
+    Loader loader;
+    View view(model, loader);
+    REQUIRE(offscreen.get_dimensions() == view.initial_window_dimensions());
+
+    for (Sprite const* sprite : view.finish_loading())
+        offscreen.prepare(*sprite);
+
+    auto draw = [&](Sprite_set& sprites) { view.draw(sprites); };
+
+    // The second frame draws the scene the first one built.
+    offscreen.render(draw);
+    offscreen.render(draw);
+
+    Rgba_image actual = offscreen.snapshot();
+    std::string golden_path = std::string(GOLDEN_DIR) + "/" + name + ".png";
+
+    if (std::getenv("GE211_UPDATE_GOLDEN")) {
+        actual.save_png(golden_path);
+        WARN("Saved new golden image " << golden_path);
+        return;
+    }
+
+    if (!std::ifstream(golden_path)) {
+        actual.save_png(name + ".actual.png");
+        FAIL("No golden image " << golden_path
+             << "; run with GE211_UPDATE_GOLDEN=1 to make it");
+    }
+
+    Rgba_image golden = Rgba_image::load(golden_path);
+    REQUIRE(golden.dimensions == actual.dimensions);
+
+    long mismatched = 0;
+    for (size_t i = 0; i < actual.pixels.size(); i += 4) {
+        for (size_t j = i; j < i + 4; ++j) {
+            if (std::abs(actual.pixels[j] - golden.pixels[j]) >
+                channel_tolerance) {
+                ++mismatched;
+                break;
+            }
+        }
+    }
+
+    if (mismatched) actual.save_png(name + ".actual.png");
+
+    INFO(name << ": " << mismatched << " pixels differ from " << golden_path);
+    CHECK(mismatched == 0);
+}
+
+TEST_CASE("view at the start of a match")
+{
+    Model model;
+    check_scenario("start", model);
+}
+
+TEST_CASE("view in the middle of a match with 500 balls")
+{
+    Model model;
+    Test_access access(model);
+
+    for (int level = 1; level <= max_level_; ++level) {
+        Turret red(Player::red, {60 * level, 80});
+        Turret blue(Player::blue, {width_ - 60 * level, height_ - 80});
+        for (int i = 1; i < level; ++i) {
+            red.level_up();
+            blue.level_up();
+        }
+        access.turrets().push_back(red);
+        access.turrets().push_back(blue);
+    }
+
+    // Spread the balls over the arena in a fixed pattern.
+    for (int i = 0; i < 500; ++i) {
+        Player player = i % 2 ? Player::red : Player::blue;
+        ge211::Position position{10 + (i * 37) % (width_ - 20),
+                                 10 + (i * 53) % (height_ - 20)};
+        access.balls().emplace_back(player, position,
+                                    ge211::Position{0, 0}, (i / 2) % 2);
+    }
+
+    model.red_.change_money(350);
+    model.blue_.change_lives();
+    model.blue_.change_lives();
+    model.red_.change_lives();
+
+    check_scenario("mid_match", model);
+}
+
+TEST_CASE("view after red wins")
+{
+    Model model;
+    for (int i = 0; i < live_count_; ++i)
+        model.blue_.change_lives();
+    model.update(0);
+    REQUIRE(model.get_winner() == Player::red);
+
+    check_scenario("red_victory", model);
+}
+
+TEST_CASE("view after blue wins")
+{
+    Model model;
+    for (int i = 0; i < live_count_; ++i)
+        model.red_.change_lives();
+    model.update(0);
+    REQUIRE(model.get_winner() == Player::blue);
+
+    check_scenario("blue_victory", model);
+}